@@ -43,10 +43,13 @@
 //----------------------------------------------------------------------
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
+#include <type_traits>
+#include <utility>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
 //----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tBufferManagementInfo.h"
 #include "rrlib/buffer_pools/tGarbageFromDeletedBufferPools.h"
 
 //----------------------------------------------------------------------
@@ -85,24 +88,24 @@ class CollectGarbage : private rrlib::util::tNoncopyable
 //----------------------------------------------------------------------
 public:
 
-  CollectGarbage() : buffer_management(new TBufferManagementPolicy()) {}
+  CollectGarbage() : garbage(new tGarbage()) {}
 
   ~CollectGarbage()
   {
-    int missing_buffers = buffer_management->DeleteGarbage();
+    int missing_buffers = garbage->buffer_management.DeleteGarbage();
     if (missing_buffers <= 0)
     {
-      delete buffer_management;
+      delete garbage;
     }
     else
     {
-      tGarbageFromDeletedBufferPools::AddPool(new tGarbage(*buffer_management));
+      tGarbageFromDeletedBufferPools::AddPool(garbage, missing_buffers); // no memory is allocated here
     }
   }
 
   TBufferManagementPolicy& GetBufferManagement()
   {
-    return *buffer_management;
+    return garbage->buffer_management;
   }
 
 //----------------------------------------------------------------------
@@ -110,21 +113,13 @@ public:
 //----------------------------------------------------------------------
 private:
 
-  /*!
-   * Buffer management object.
-   * Allocated seperately so that it can exist longer than buffer pool.
-   */
-  TBufferManagementPolicy* buffer_management;
-
+  /*! Buffer management object - together with list node for the case it becomes garbage */
   class tGarbage : public tGarbageFromDeletedBufferPools
   {
   public:
-    tGarbage(TBufferManagementPolicy& buffer_management) : buffer_management(buffer_management) {}
 
-    virtual ~tGarbage()
-    {
-      delete &buffer_management;
-    }
+    /*! Buffer management object */
+    TBufferManagementPolicy buffer_management;
 
   private:
     virtual int DeleteBufferPoolGarbage() override
@@ -132,9 +127,19 @@ private:
       return buffer_management.DeleteGarbage();
     }
 
-    TBufferManagementPolicy& buffer_management;
+    virtual size_t GetBufferSize() const override
+    {
+      typedef decltype(std::declval<TBufferManagementPolicy&>().GetUnusedBuffer(std::declval<tBufferManagementInfo&>())) tBufferPointer;
+      return tBufferMemorySize<typename std::remove_pointer<tBufferPointer>::type>::Get();
+    }
   };
 
+  /*!
+   * Buffer management object (and list node).
+   * Allocated seperately so that it can exist longer than buffer pool.
+   */
+  tGarbage* garbage;
+
 };
 
 //----------------------------------------------------------------------
@@ -39,6 +39,7 @@
 //----------------------------------------------------------------------
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
+#include <utility>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
@@ -64,6 +65,8 @@ namespace deleting
 //! Complain if buffers are in use
 /*!
  * Deleting policy that will complain if buffers are in use when pool is deleted.
+ * If the management policy tracks outstanding buffers (see management::WithLeakTracking),
+ * the records of the missing buffers are printed as well.
  */
 template <typename TBufferManagementPolicy>
 class ComplainOnMissingBuffers : public TBufferManagementPolicy
@@ -81,6 +84,7 @@ public:
     {
       RRLIB_LOG_PRINT(ERROR, "At least ", missing_buffers, " buffers have not been returned to buffer pool. This will result in segmentation violations when the remaining buffers are recycled.\
                              If you cannot ensure that all buffers are returned, use different deleting policy.");
+      DumpOutstandingBuffers(0);
     }
   }
 
@@ -94,6 +98,13 @@ public:
 //----------------------------------------------------------------------
 private:
 
+  template <typename TPolicy = TBufferManagementPolicy>
+  auto DumpOutstandingBuffers(int) -> decltype(std::declval<TPolicy&>().DumpOutstandingBuffers(), void())
+  {
+    TPolicy::DumpOutstandingBuffers();
+  }
+
+  void DumpOutstandingBuffers(long) {} // management policy does not track outstanding buffers
 };
 
 //----------------------------------------------------------------------
@@ -0,0 +1,260 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/policies/deleting/DeleteOnLastReturn.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains DeleteOnLastReturn
+ *
+ * \b DeleteOnLastReturn
+ *
+ * Deleting policy that deletes pool when the last buffer in use is returned.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__policies__deleting__DeleteOnLastReturn_h__
+#define __rrlib__buffer_pools__policies__deleting__DeleteOnLastReturn_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/util/tNoncopyable.h"
+#include <atomic>
+#include <utility>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tBufferManagementInfo.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+namespace deleting
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+template <typename TBufferManagementPolicy>
+class DeleteOnLastReturn;
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Buffer management that counts buffers in use
+/*!
+ * Buffer management policy that passes all operations to another management policy
+ * and maintains a reference counter: the number of buffers in use plus one while the pool exists.
+ * When the counter drops to zero, the management object deletes itself.
+ * This class is used by tBufferPool with the DeleteOnLastReturn deleting policy.
+ *
+ * The management policy must be able to determine the owner from a buffer's
+ * management info (GetOwner() - e.g. QueueBased, QueueBasedWithThreadLocalCache and StackBased).
+ *
+ * TBufferManagement  Buffer management policy (instantiated) to pass operations to
+ */
+template <typename TBufferManagement>
+class ReturnCountingManagement : public TBufferManagement
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  ReturnCountingManagement() : references(1) {}
+
+  template <typename T>
+  void AddBuffer(T* buffer, tBufferManagementInfo& info)
+  {
+    references.fetch_add(1, std::memory_order_relaxed);
+    TBufferManagement::AddBuffer(buffer, info);
+  }
+
+  template <typename T>
+  void AdoptBuffer(T* buffer, tBufferManagementInfo& info)
+  {
+    ReturnCountingManagement* previous_owner = GetOwner(info);
+    if (previous_owner != this)
+    {
+      references.fetch_add(1, std::memory_order_relaxed);
+      TBufferManagement::AdoptBuffer(buffer, info);
+      previous_owner->Release(1);
+    }
+  }
+
+  static ReturnCountingManagement* GetOwner(const tBufferManagementInfo& info)
+  {
+    return static_cast<ReturnCountingManagement*>(TBufferManagement::GetOwner(info));
+  }
+
+  auto GetUnusedBuffer(tBufferManagementInfo& info) -> decltype(std::declval<TBufferManagement&>().GetUnusedBuffer(info))
+  {
+    auto buffer = TBufferManagement::GetUnusedBuffer(info);
+    if (buffer)
+    {
+      references.fetch_add(1, std::memory_order_relaxed);
+    }
+    return buffer;
+  }
+
+  template <typename TFunction>
+  size_t GetUnusedBuffers(size_t count, TFunction function)
+  {
+    size_t obtained = TBufferManagement::GetUnusedBuffers(count, function);
+    references.fetch_add(obtained, std::memory_order_relaxed);
+    return obtained;
+  }
+
+  template <typename T>
+  static void RecycleBuffer(const tBufferManagementInfo& info, T* buffer)
+  {
+    ReturnCountingManagement* owner = GetOwner(info);
+    TBufferManagement::RecycleBuffer(info, buffer);
+    owner->Release(1);
+  }
+
+  template <typename T>
+  static void RecycleBuffers(const std::pair<tBufferManagementInfo, T*>* buffers, size_t count)
+  {
+    TBufferManagement::RecycleBuffers(buffers, count);
+    for (size_t i = 0; i < count;)
+    {
+      ReturnCountingManagement* owner = GetOwner(buffers[i].first);
+      size_t owner_count = 1;
+      for (i++; i < count && GetOwner(buffers[i].first) == owner; i++)
+      {
+        owner_count++;
+      }
+      owner->Release(owner_count);
+    }
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  template <typename TBufferManagementPolicy>
+  friend class DeleteOnLastReturn;
+
+  /*! Number of buffers in use - plus one as long as pool exists */
+  std::atomic<size_t> references;
+
+
+  /*!
+   * Releases references. Deletes this object when last reference is released.
+   *
+   * \param count Number of references to release
+   */
+  void Release(size_t count)
+  {
+    if (references.fetch_sub(count, std::memory_order_release) == count)
+    {
+      std::atomic_thread_fence(std::memory_order_acquire); // see all recycling operations before deleting buffers
+      TBufferManagement::DeleteGarbage();
+      delete this;
+    }
+  }
+};
+
+//! Delete pool when last buffer is returned
+/*!
+ * Deleting policy that deletes all unused buffers when pool is deleted.
+ * If buffers are still in use, the pool's management object stays in memory
+ * and is deleted by the thread that returns the last of these buffers -
+ * without any need to call tGarbageFromDeletedBufferPools::DeleteGarbage().
+ *
+ * Buffers in use are counted by ReturnCountingManagement: acquiring and recycling
+ * buffers involves one additional atomic counter update (relaxed on acquire).
+ * Requires a buffer management policy that provides GetOwner() - e.g. QueueBased or StackBased.
+ */
+template <typename TBufferManagementPolicy>
+class DeleteOnLastReturn : private util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  DeleteOnLastReturn() : buffer_management(new TBufferManagementPolicy()) {}
+
+  ~DeleteOnLastReturn()
+  {
+    buffer_management->DeleteGarbage();
+    buffer_management->Release(1);
+  }
+
+  TBufferManagementPolicy& GetBufferManagement()
+  {
+    return *buffer_management;
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*!
+   * Buffer management object.
+   * Allocated seperately so that it can exist longer than buffer pool.
+   */
+  TBufferManagementPolicy* buffer_management;
+
+};
+
+/*!
+ * Buffer management type that tBufferPool uses with a deleting policy
+ * (deleting policies may need to extend the buffer management policy)
+ *
+ * TDeletingPolicy          Deleting policy
+ * TBufferManagementPolicy  Buffer management policy (instantiated)
+ */
+template <template <typename> class TDeletingPolicy, typename TBufferManagementPolicy>
+struct tBufferManagementForDeletingPolicy
+{
+  typedef TBufferManagementPolicy type;
+};
+
+template <typename TBufferManagementPolicy>
+struct tBufferManagementForDeletingPolicy<DeleteOnLastReturn, TBufferManagementPolicy>
+{
+  typedef ReturnCountingManagement<TBufferManagementPolicy> type;
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+
+#endif
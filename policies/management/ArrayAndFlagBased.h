@@ -41,11 +41,20 @@
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
 #include "rrlib/thread/tThread.h"
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
 //----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tClaimConflictCounter.h"
 #include "rrlib/buffer_pools/tNotifyOnRecycle.h"
 
 //----------------------------------------------------------------------
@@ -62,6 +71,41 @@ namespace management
 // Forward declarations / typedefs / enums
 //----------------------------------------------------------------------
 
+/*! Scan strategy: Search for unused buffers always starts at first buffer */
+struct FirstFit {};
+
+/*!
+ * Scan strategy: Search for unused buffers starts at array chunk of last successful acquisition.
+ * This spreads contention among concurrent readers and avoids walking the same busy prefix over and over again.
+ */
+struct NextFit {};
+
+/*!
+ * Memory layout of the array chunks of ArrayAndFlagBased
+ *
+ * CHUNK_SIZE          Number of buffers in first array chunk (every further chunk is twice as large as its predecessor)
+ * CACHE_LINE_ALIGNED  Align array chunks to cache lines
+ * PAD_SLOTS           Place every buffer slot in a cache line of its own.
+ *                     This avoids false sharing among threads recycling neighbouring buffers - at the cost of memory.
+ *                     Implies CACHE_LINE_ALIGNED.
+ */
+template <size_t CHUNK_SIZE, bool CACHE_LINE_ALIGNED = false, bool PAD_SLOTS = false>
+struct ArrayChunkLayout
+{
+  static_assert(CHUNK_SIZE > 0, "Array chunks must contain at least one buffer");
+
+  enum { cCHUNK_SIZE = CHUNK_SIZE };
+  enum { cCACHE_LINE_ALIGNED = CACHE_LINE_ALIGNED || PAD_SLOTS };
+  enum { cPAD_SLOTS = PAD_SLOTS };
+  enum { cCACHE_LINE_SIZE = 64 };
+};
+
+/*! Default layout (packed chunks - first one with 15 buffers) */
+typedef ArrayChunkLayout<15> PackedArrayChunks;
+
+/*! Layout with every buffer slot in a cache line of its own */
+typedef ArrayChunkLayout<15, true, true> PaddedArrayChunks;
+
 //----------------------------------------------------------------------
 // Class declaration
 //----------------------------------------------------------------------
@@ -70,74 +114,128 @@ namespace management
  * Buffers are stored in an array list.
  * Whether buffers are in use is signaled by a flag.
  *
+ * The 'array' is a directory of array chunks with geometrically growing sizes.
+ * Thus, a buffer index maps to its slot in constant time
+ * and buffers can be added in constant time without any locking.
+ *
+ * Slots of buffers removed by RemoveUnusedBuffers are kept in a lock-free list of free slots
+ * and reused by AddBuffer (lowest index first).
+ * Trailing free slots are cut off the array - and array chunks beyond its end are reclaimed.
+ * Only if AddBuffer grows the array into a chunk whose pages are being returned to the operating
+ * system at that moment, it waits (without locking) until this is complete.
+ *
  * Pro: Any type T can be used
  * Con: May not scale well with many buffers
  *
- * TAddMutex Mutex to protect AddBuffer operation with (may be tNoMutex if concurrent adding does not occur)
+ * TAddMutex Mutex to protect DeleteGarbage and RemoveUnusedBuffers operations with (AddBuffer is lock-free)
+ * TScanStrategy Where search for unused buffers starts (FirstFit or NextFit)
+ * TArrayChunkLayout Memory layout of array chunks (see ArrayChunkLayout)
  */
 template < typename T,
          concurrent_containers::tConcurrency CONCURRENCY,
          typename TBufferDeleter,
-         typename TAddMutex = typename std::conditional < (CONCURRENCY == concurrent_containers::tConcurrency::FULL) || (CONCURRENCY == concurrent_containers::tConcurrency::MULTIPLE_READERS), thread::tMutex, thread::tNoMutex >::type >
+         typename TAddMutex = typename std::conditional < (CONCURRENCY == concurrent_containers::tConcurrency::FULL) || (CONCURRENCY == concurrent_containers::tConcurrency::MULTIPLE_READERS), thread::tMutex, thread::tNoMutex >::type,
+         typename TScanStrategy = FirstFit,
+         typename TArrayChunkLayout = PackedArrayChunks >
 class ArrayAndFlagBased : public TAddMutex
 {
+  static_assert(std::is_same<TScanStrategy, FirstFit>::value || std::is_same<TScanStrategy, NextFit>::value, "Invalid scan strategy");
+
   enum { cMULTIPLE_READERS = (CONCURRENCY == concurrent_containers::tConcurrency::FULL) || (CONCURRENCY == concurrent_containers::tConcurrency::MULTIPLE_READERS) };
+  enum { cNEXT_FIT = std::is_same<TScanStrategy, NextFit>::value };
   enum { cATOMIC_ARRAY_ELEMENTS = (CONCURRENCY != concurrent_containers::tConcurrency::NONE) };
-  enum { cARRAY_CHUNK_SIZE = 15 }; // TODO make this template argument
+  enum { cFIRST_ARRAY_CHUNK_SIZE = TArrayChunkLayout::cCHUNK_SIZE };
+  enum { cMAX_ARRAY_CHUNKS = 31 }; // more than 2^31 buffers cannot be indexed with int anyway
+  static constexpr size_t cCHUNK_ALIGNMENT = TArrayChunkLayout::cCACHE_LINE_ALIGNED ? static_cast<size_t>(TArrayChunkLayout::cCACHE_LINE_SIZE) : alignof(void*);
+  static constexpr size_t cSLOT_ALIGNMENT = TArrayChunkLayout::cPAD_SLOTS ? static_cast<size_t>(TArrayChunkLayout::cCACHE_LINE_SIZE) : alignof(void*);
   typedef typename std::conditional<cATOMIC_ARRAY_ELEMENTS, std::atomic<T*>, T*>::type tArrayElement;
-  struct tArrayChunk;
-  typedef typename std::conditional<cMULTIPLE_READERS, std::atomic<tArrayChunk*>, tArrayChunk*>::type tNextArrayChunkPointer;
-  typedef typename std::conditional<cMULTIPLE_READERS, std::atomic<int>, int>::type tBufferCount;
+  typedef typename std::conditional<cMULTIPLE_READERS, std::atomic<uintptr_t>, uintptr_t>::type tSlotLink;
+  typedef typename std::conditional<cMULTIPLE_READERS, std::atomic<uint64_t>, uint64_t>::type tFreeSlotList;
 
-  /*! The 'array' is a linked list of array chunks */
-  struct tArrayChunk
-  {
-    /*! Buffers in array chunk. NULL for buffers that are in use. */
-    std::array<tArrayElement, cARRAY_CHUNK_SIZE> buffers;
+  /*! States of array chunks (only used with multiple readers - see ReclaimArrayChunk) */
+  enum { cCHUNK_IN_USE, cCHUNK_RELEASING, cCHUNK_RELEASED };
 
-    /*! Pointer to next chunk -> linked-list */
-    tNextArrayChunkPointer next_chunk;
+  /*! Buffer slot in array chunk (possibly padded to cache line size) */
+  struct alignas(cSLOT_ALIGNMENT) tSlot
+  {
+    /*! Buffer in this slot. NULL if buffer is in use. (first member: buffer management info points to slot) */
+    tArrayElement element;
 
-    ~tArrayChunk()
-    {
-      tArrayChunk* next = next_chunk;
-      delete next;
-    }
+    /*!
+     * While slot is assigned to a buffer: buffer management object of pool that slot belongs to.
+     * While slot is in list of free slots: index of next free slot plus one (zero at end of list).
+     */
+    tSlotLink link;
   };
 
+  typedef typename std::conditional<cMULTIPLE_READERS, std::atomic<tSlot*>, tSlot*>::type tArrayChunkPointer;
+  typedef typename std::conditional<cMULTIPLE_READERS, std::atomic<int>, int>::type tBufferCount;
+
 //----------------------------------------------------------------------
 // Public methods and typedefs
 //----------------------------------------------------------------------
 public:
 
   ArrayAndFlagBased() :
-    first_array_chunk(), buffer_count(0)
+    array_chunks(), buffer_count(0), deleted_buffer_count(0), scan_start_index(0), free_slots(0), array_chunk_states()
   {}
 
+  ~ArrayAndFlagBased()
+  {
+    for (auto it = array_chunks.begin(); it != array_chunks.end(); ++it)
+    {
+      free(static_cast<tSlot*>(*it));
+    }
+  }
+
   void AddBuffer(T* buffer, tBufferManagementInfo& info)
   {
-    thread::tLock lock(*this);
-    int count = buffer_count;
-    tArrayChunk* current = &first_array_chunk;
-    while (count >= cARRAY_CHUNK_SIZE)
+    // Reuse slot of removed buffer
+    uint64_t free_slot_list = LoadAcquire(free_slots);
+    while (GetFirstFreeSlot(free_slot_list))
     {
-      count -= cARRAY_CHUNK_SIZE;
-      tArrayChunk* next = current->next_chunk;
-      if (next)
-      {
-        current = next;
-      }
-      else
+      // Slot may be taken by another thread meanwhile - then link is garbage, but compare-and-swap fails due to changed tag
+      tSlot& slot = GetSlot(static_cast<int>(GetFirstFreeSlot(free_slot_list)) - 1); // chunk exists, as free slots are below buffer_count
+      if (CompareExchange(free_slots, free_slot_list, MakeFreeSlotList(LoadRelaxed(slot.link), free_slot_list)))
       {
-        // slightly verbose as current->next_chunk might be atomic
-        next = new tArrayChunk();
-        current->next_chunk = next;
-        current = next;
+        deleted_buffer_count--;
+        AssignSlot(slot, info);
+        return;
       }
     }
-    //current->buffers[count] = buffer; // will be done by recycler
-    info.buffer_management_info = &(current->buffers[count]);
-    buffer_count = count + 1; // more efficient than ++-operator - safe due to lock
+
+    int index = FetchAdd(buffer_count, 1);
+    int offset = 0;
+    int chunk_index = GetArrayChunkIndex(index, offset);
+    assert(chunk_index < cMAX_ARRAY_CHUNKS && "Maximum number of buffers exceeded");
+    tSlot* chunk = GetOrCreateArrayChunk(chunk_index);
+    if (cMULTIPLE_READERS)
+    {
+      AcquireArrayChunk(chunk_index);
+    }
+    //chunk[offset].element = buffer; // will be done by recycler
+    AssignSlot(chunk[offset], info);
+  }
+
+  /*!
+   * Prepares management structures for the specified number of additional buffers
+   *
+   * \param additional_buffers Number of buffers that are about to be added
+   */
+  void Reserve(size_t additional_buffers)
+  {
+    if (additional_buffers == 0)
+    {
+      return;
+    }
+    int offset = 0;
+    int first_chunk_index = GetArrayChunkIndex(buffer_count, offset);
+    int last_chunk_index = GetArrayChunkIndex(buffer_count + static_cast<int>(additional_buffers) - 1, offset);
+    assert(last_chunk_index < cMAX_ARRAY_CHUNKS && "Maximum number of buffers exceeded");
+    for (int i = first_chunk_index; i <= last_chunk_index; i++)
+    {
+      GetOrCreateArrayChunk(i);
+    }
   }
 
   /*!
@@ -146,48 +244,166 @@ public:
   int DeleteGarbage()
   {
     thread::tLock lock(*this); // should not be necessary, if pool is used sensibly, but does not hurt
-    int remaining_buffers = this->buffer_count;
-    tArrayChunk* current = &first_array_chunk;
-    while (remaining_buffers > 0)
+    int buffer_count = this->buffer_count;
+    for (int chunk_index = 0, first_index = 0; first_index < buffer_count; first_index += GetArrayChunkSize(chunk_index), chunk_index++)
     {
-      for (auto it = current->buffers.begin(); (it != current->buffers.end()) && (remaining_buffers > 0); ++it, remaining_buffers--)
+      tSlot* chunk = array_chunks[chunk_index];
+      int end = std::min<int>(GetArrayChunkSize(chunk_index), buffer_count - first_index);
+      for (int i = 0; chunk && i < end; i++)
       {
-        T* buffer = (*it);
-        if (buffer)
+        T* buffer = chunk[i].element;
+        if (buffer && MarkBufferUsed(chunk[i].element, buffer))
         {
           TBufferDeleter deleter;
           deleter(buffer);
-          this->buffer_count--;
+          deleted_buffer_count++;
         }
       }
-      current = current->next_chunk;
     }
-    return this->buffer_count;
+    return buffer_count - deleted_buffer_count;
+  }
+
+  /*!
+   * \return Number of buffers in this pool (including buffers in use)
+   */
+  size_t GetBufferCount()
+  {
+    thread::tLock lock(*this);
+    return buffer_count - deleted_buffer_count;
+  }
+
+  /*!
+   * Determines number of unused buffers without obtaining them (e.g. for trimming idle buffers).
+   * Buffers may be obtained and recycled concurrently - so the result is a snapshot only.
+   *
+   * \return Number of unused buffers in this pool
+   */
+  size_t GetUnusedBufferCount()
+  {
+    size_t count = 0;
+    int buffer_count = this->buffer_count;
+    for (int chunk_index = 0, first_index = 0; first_index < buffer_count; first_index += GetArrayChunkSize(chunk_index), chunk_index++)
+    {
+      tSlot* chunk = LoadAcquire(array_chunks[chunk_index]);
+      int end = std::min<int>(GetArrayChunkSize(chunk_index), buffer_count - first_index);
+      for (int i = 0; chunk && i < end; i++)
+      {
+        count += LoadRelaxed(chunk[i].element) ? 1 : 0;
+      }
+    }
+    return count;
   }
 
   T* GetUnusedBuffer(tBufferManagementInfo& info)
   {
-    int remaining_buffers = this->buffer_count;
-    tArrayChunk* current = &first_array_chunk;
-    while (remaining_buffers > 0)
+    T* result = NULL;
+    info.buffer_management_info = NULL;
+    GetUnusedBuffers(1, [&](T * buffer, const tBufferManagementInfo & buffer_info)
+    {
+      result = buffer;
+      info = buffer_info;
+    });
+    return result;
+  }
+
+  /*!
+   * Obtains up to count unused buffers in one operation
+   *
+   * \param count Maximum number of buffers to obtain
+   * \param function Function (T* buffer, const tBufferManagementInfo& info) to call for every buffer obtained
+   * \return Number of buffers obtained
+   */
+  template <typename TFunction>
+  size_t GetUnusedBuffers(size_t count, TFunction function)
+  {
+    int buffer_count = this->buffer_count;
+    int start_index = cNEXT_FIT ? std::min<int>(LoadRelaxed(scan_start_index), buffer_count) : 0;
+    size_t obtained = ScanArray(start_index, buffer_count, count, function);
+    if (obtained < count && start_index > 0)
+    {
+      obtained += ScanArray(0, start_index, count - obtained, function); // wrap around
+    }
+    return obtained;
+  }
+
+  /*!
+   * \return Number of array chunks that currently hold memory
+   */
+  size_t GetArrayChunkCount()
+  {
+    thread::tLock lock(*this);
+    size_t count = 0;
+    for (int i = 0; i < cMAX_ARRAY_CHUNKS; i++)
+    {
+      count += (LoadAcquire(array_chunks[i]) && !(cMULTIPLE_READERS && array_chunk_states[i].load() == cCHUNK_RELEASED)) ? 1 : 0;
+    }
+    return count;
+  }
+
+  /*!
+   * Removes up to count unused buffers from this pool and deletes them.
+   * Buffers with the highest indices are removed first. Their slots are reused by AddBuffer.
+   * Free slots at the end of the array are cut off, and array chunks beyond the array's end are reclaimed:
+   * With a single reader, memory is freed immediately (method must be called by reader thread then).
+   * With multiple readers, concurrent readers might still access the chunk - so its pages are returned
+   * to the operating system, while the chunk is kept to be reused when the pool grows again.
+   *
+   * \param count Maximum number of buffers to remove
+   * \return Number of buffers removed
+   */
+  size_t RemoveUnusedBuffers(size_t count)
+  {
+    thread::tLock lock(*this);
+    std::vector<int> free_indices = DetachFreeSlots();
+    size_t removed = 0;
+    int offset = 0;
+    int buffer_count = this->buffer_count;
+    for (int chunk_index = buffer_count ? GetArrayChunkIndex(buffer_count - 1, offset) : -1; chunk_index >= 0 && removed < count; chunk_index--)
     {
-      for (auto it = current->buffers.begin(); (it != current->buffers.end()) && (remaining_buffers > 0); ++it, remaining_buffers--)
+      tSlot* chunk = array_chunks[chunk_index];
+      int first_index = GetFirstIndex(chunk_index);
+      int end = std::min<int>(GetArrayChunkSize(chunk_index), buffer_count - first_index);
+      for (int i = end - 1; chunk && i >= 0 && removed < count; i--)
       {
-        T* buffer = (*it);
-        if (buffer)
+        T* buffer = chunk[i].element;
+        if (buffer && MarkBufferUsed(chunk[i].element, buffer)) // slot remains NULL until it is reused by AddBuffer
         {
-          tArrayElement* array_entry = &(*it);
-          if (MarkBufferUsed(*array_entry, buffer)) // write NULL to array to indicate that buffer is used
-          {
-            info.buffer_management_info = array_entry;
-            return buffer;
-          }
+          TBufferDeleter deleter;
+          deleter(buffer);
+          deleted_buffer_count++;
+          free_indices.push_back(first_index + i);
+          removed++;
         }
       }
-      current = current->next_chunk;
     }
-    info.buffer_management_info = NULL;
-    return NULL;
+
+    // Cut off free slots at end of array (stops if buffers are added concurrently)
+    std::sort(free_indices.begin(), free_indices.end());
+    while ((!free_indices.empty()) && free_indices.back() == buffer_count - 1 && CompareExchange(this->buffer_count, buffer_count, buffer_count - 1))
+    {
+      free_indices.pop_back();
+      deleted_buffer_count--;
+      buffer_count--;
+    }
+    PushFreeSlots(free_indices);
+
+    for (int chunk_index = buffer_count ? GetArrayChunkIndex(buffer_count - 1, offset) + 1 : 0; chunk_index < cMAX_ARRAY_CHUNKS; chunk_index++)
+    {
+      if (array_chunks[chunk_index])
+      {
+        ReclaimArrayChunk(chunk_index);
+      }
+    }
+    return removed;
+  }
+
+  /*!
+   * \param info Buffer management info of a buffer (obtained from a pool with this policy)
+   * \return Buffer management object of pool that buffer belongs to
+   */
+  static ArrayAndFlagBased* GetOwner(const tBufferManagementInfo& info)
+  {
+    return reinterpret_cast<ArrayAndFlagBased*>(LoadRelaxed(static_cast<tSlot*>(info.buffer_management_info)->link));
   }
 
   static void RecycleBuffer(const tBufferManagementInfo& info, T* buffer)
@@ -198,17 +414,308 @@ public:
     *array_entry = buffer; // restore pointer (NULL -> buffer pointer)
   }
 
+  /*!
+   * Recycles multiple buffers in one operation
+   * (buffers may originate from different pools)
+   *
+   * \param buffers Buffers to recycle together with their buffer management info
+   * \param count Number of buffers
+   */
+  static void RecycleBuffers(const std::pair<tBufferManagementInfo, T*>* buffers, size_t count)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      NotifyOnRecycle(buffers[i].second);
+    }
+    std::atomic_thread_fence(std::memory_order_release); // a single fence publishes all buffers
+    for (size_t i = 0; i < count; i++)
+    {
+      assert(buffers[i].first.buffer_management_info && "Received empty buffer_management_info. This is not allowed using this policy.");
+      StoreRelaxed(*static_cast<tArrayElement*>(buffers[i].first.buffer_management_info), buffers[i].second);
+    }
+  }
+
 //----------------------------------------------------------------------
 // Private fields and methods
 //----------------------------------------------------------------------
 private:
 
-  /*! First array chunk in 'array' */
-  tArrayChunk first_array_chunk;
+  /*! Directory of array chunks: Array chunk i contains cFIRST_ARRAY_CHUNK_SIZE * 2^i buffers */
+  std::array<tArrayChunkPointer, cMAX_ARRAY_CHUNKS> array_chunks;
 
-  /*! Number of buffers in this pool */
+  /*! Number of buffers that have been added to this pool (= number of slots in use) */
   tBufferCount buffer_count;
 
+  /*! Number of buffers deleted by DeleteGarbage() or RemoveUnusedBuffers() whose slots have not been reused yet */
+  tBufferCount deleted_buffer_count;
+
+  /*! Index of last successful acquisition (only used with NextFit) */
+  tBufferCount scan_start_index;
+
+  /*!
+   * Lock-free list (stack) of free slots below buffer_count - left by RemoveUnusedBuffers().
+   * Lower 32 bits: index of first free slot plus one (zero if list is empty). Upper 32 bits: tag that is incremented on every change (against ABA problem).
+   * Slots are linked via tSlot::link. Only RemoveUnusedBuffers() adds slots (with mutex locked) - keeping them sorted by index.
+   */
+  tFreeSlotList free_slots;
+
+  /*! State of every array chunk (only used with multiple readers - see ReclaimArrayChunk) */
+  std::array<std::atomic<int>, cMAX_ARRAY_CHUNKS> array_chunk_states;
+
+
+  /*!
+   * Assigns slot to buffer that is being added
+   *
+   * \param slot Slot to assign
+   * \param info Buffer management info of buffer (points to slot after call)
+   */
+  void AssignSlot(tSlot& slot, tBufferManagementInfo& info)
+  {
+    StoreRelaxed(slot.link, reinterpret_cast<uintptr_t>(this));
+    info.buffer_management_info = &slot;
+  }
+
+  /*!
+   * Waits until pages of array chunk that array grows into are no longer being returned to the operating system (see ReclaimArrayChunk).
+   * Must be called after incrementing buffer_count.
+   *
+   * \param chunk_index Index of array chunk
+   */
+  void AcquireArrayChunk(int chunk_index)
+  {
+    int state = array_chunk_states[chunk_index].load();
+    while (state != cCHUNK_IN_USE)
+    {
+      if (state == cCHUNK_RELEASING)
+      {
+        std::this_thread::yield(); // RemoveUnusedBuffers will either abort or complete releasing chunk shortly
+        state = array_chunk_states[chunk_index].load();
+      }
+      else
+      {
+        array_chunk_states[chunk_index].compare_exchange_strong(state, cCHUNK_IN_USE);
+      }
+    }
+  }
+
+  /*!
+   * Removes all slots from list of free slots
+   *
+   * \return Indices of the removed slots
+   */
+  std::vector<int> DetachFreeSlots()
+  {
+    std::vector<int> result;
+    uint64_t free_slot_list = LoadAcquire(free_slots);
+    while (!CompareExchange(free_slots, free_slot_list, MakeFreeSlotList(0, free_slot_list)))
+    {}
+    for (uintptr_t next = GetFirstFreeSlot(free_slot_list); next; next = LoadRelaxed(GetSlot(static_cast<int>(next) - 1).link))
+    {
+      result.push_back(static_cast<int>(next) - 1);
+    }
+    return result;
+  }
+
+  /*!
+   * Adds slots to (empty) list of free slots.
+   * Must only be called with mutex locked.
+   *
+   * \param indices Indices of slots to add (sorted)
+   */
+  void PushFreeSlots(const std::vector<int>& indices)
+  {
+    if (indices.empty())
+    {
+      return;
+    }
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+      StoreRelaxed(GetSlot(indices[i]).link, i + 1 < indices.size() ? static_cast<uintptr_t>(indices[i + 1] + 1) : static_cast<uintptr_t>(0));
+    }
+    uint64_t free_slot_list = LoadRelaxed(free_slots); // list is empty, as only this method adds slots (AddBuffer only removes slots)
+    while (!CompareExchange(free_slots, free_slot_list, MakeFreeSlotList(indices[0] + 1, free_slot_list)))
+    {}
+  }
+
+  /*!
+   * \param free_slot_list Value of free_slots
+   * \return Index of first free slot plus one (zero if list is empty)
+   */
+  static uintptr_t GetFirstFreeSlot(uint64_t free_slot_list)
+  {
+    return static_cast<uintptr_t>(free_slot_list & 0xFFFFFFFFu);
+  }
+
+  /*!
+   * \param first_free_slot Index of first free slot plus one (zero if list is empty)
+   * \param previous Previous value of free_slots
+   * \return New value for free_slots (with incremented tag)
+   */
+  static uint64_t MakeFreeSlotList(uintptr_t first_free_slot, uint64_t previous)
+  {
+    return ((previous & 0xFFFFFFFF00000000ull) + 0x100000000ull) | static_cast<uint64_t>(first_free_slot);
+  }
+
+  /*!
+   * \param index Buffer index (array chunk must exist)
+   * \return Slot of buffer with specified index
+   */
+  tSlot& GetSlot(int index)
+  {
+    int offset = 0;
+    int chunk_index = GetArrayChunkIndex(index, offset);
+    return static_cast<tSlot*>(LoadAcquire(array_chunks[chunk_index]))[offset];
+  }
+
+  static int GetArrayChunkSize(int chunk_index)
+  {
+    return cFIRST_ARRAY_CHUNK_SIZE << chunk_index;
+  }
+
+  /*!
+   * \return Index of first buffer in array chunk with specified index
+   */
+  static int GetFirstIndex(int chunk_index)
+  {
+    return cFIRST_ARRAY_CHUNK_SIZE * ((1 << chunk_index) - 1);
+  }
+
+  /*!
+   * \param index Buffer index
+   * \param offset Contains offset of buffer in array chunk after call
+   * \return Index of array chunk that contains buffer with specified index
+   */
+  static int GetArrayChunkIndex(int index, int& offset)
+  {
+    // chunk i contains buffers [cFIRST_ARRAY_CHUNK_SIZE * (2^i - 1), cFIRST_ARRAY_CHUNK_SIZE * (2^(i+1) - 1))
+    unsigned int chunk_index = 31 - __builtin_clz(static_cast<unsigned int>(index / cFIRST_ARRAY_CHUNK_SIZE + 1));
+    offset = index - cFIRST_ARRAY_CHUNK_SIZE * ((1 << chunk_index) - 1);
+    return chunk_index;
+  }
+
+  /*!
+   * \return Array chunk with specified index. Is allocated if it does not exist yet (lock-free).
+   */
+  tSlot* GetOrCreateArrayChunk(int chunk_index)
+  {
+    tSlot* chunk = LoadAcquire(array_chunks[chunk_index]);
+    if (chunk)
+    {
+      return chunk;
+    }
+    int size = GetArrayChunkSize(chunk_index);
+    void* memory = NULL;
+    if (posix_memalign(&memory, cCHUNK_ALIGNMENT, size * sizeof(tSlot)))
+    {
+      throw std::bad_alloc();
+    }
+    tSlot* new_chunk = static_cast<tSlot*>(memory);
+    for (int i = 0; i < size; i++)
+    {
+      new (&new_chunk[i]) tSlot();
+    }
+    if (CompareExchange(array_chunks[chunk_index], chunk, new_chunk))
+    {
+      return new_chunk;
+    }
+    free(new_chunk); // another thread was faster
+    return chunk;
+  }
+
+  /*!
+   * Reclaims memory of array chunk beyond buffer_count (see RemoveUnusedBuffers)
+   *
+   * \param chunk_index Index of array chunk
+   */
+  void ReclaimArrayChunk(int chunk_index)
+  {
+    tSlot* chunk = array_chunks[chunk_index];
+    if (!cMULTIPLE_READERS)
+    {
+      array_chunks[chunk_index] = NULL;
+      free(chunk);
+      return;
+    }
+    if (array_chunk_states[chunk_index].load() == cCHUNK_RELEASED)
+    {
+      return;
+    }
+
+    // AddBuffer checks state after incrementing buffer_count - so either AddBuffer waits until chunk is released or chunk is not released
+    array_chunk_states[chunk_index].store(cCHUNK_RELEASING);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (LoadRelaxed(buffer_count) > GetFirstIndex(chunk_index))
+    {
+      array_chunk_states[chunk_index].store(cCHUNK_IN_USE);
+      return;
+    }
+
+    // Pages only contain NULL slots after being returned (-> readers skip them). Chunk stays in directory to be reused.
+    uintptr_t page_size = sysconf(_SC_PAGESIZE);
+    uintptr_t begin = (reinterpret_cast<uintptr_t>(chunk) + page_size - 1) & ~(page_size - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(chunk + GetArrayChunkSize(chunk_index)) & ~(page_size - 1);
+    if (end > begin)
+    {
+      madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED);
+    }
+    array_chunk_states[chunk_index].store(cCHUNK_RELEASED);
+  }
+
+  /*!
+   * Searches for unused buffers in the specified range of buffer indices and marks them used
+   *
+   * \param begin First index to check
+   * \param end Index to stop at
+   * \param count Maximum number of buffers to obtain
+   * \param function Function to call for every buffer obtained
+   * \return Number of buffers obtained
+   */
+  template <typename TFunction>
+  size_t ScanArray(int begin, int end, size_t count, TFunction& function)
+  {
+    size_t obtained = 0;
+    tBufferManagementInfo info;
+    int offset = 0;
+    int chunk_index = GetArrayChunkIndex(begin, offset);
+    for (int index = begin; index < end; chunk_index++, offset = 0)
+    {
+      tSlot* chunk = LoadAcquire(array_chunks[chunk_index]);
+      int chunk_end = std::min<int>(GetArrayChunkSize(chunk_index), offset + end - index);
+      if (!chunk)
+      {
+        index += chunk_end - offset; // chunk is currently being allocated by AddBuffer or has been reclaimed
+        continue;
+      }
+      for (; offset < chunk_end; offset++, index++)
+      {
+        T* buffer = chunk[offset].element;
+        if (buffer)
+        {
+          tArrayElement* array_entry = &(chunk[offset].element);
+          if (MarkBufferUsed(*array_entry, buffer)) // write NULL to array to indicate that buffer is used
+          {
+            info.buffer_management_info = array_entry;
+            function(buffer, info);
+            obtained++;
+            if (obtained == count)
+            {
+              if (cNEXT_FIT && LoadRelaxed(scan_start_index) != index)
+              {
+                StoreRelaxed(scan_start_index, index);
+              }
+              return obtained;
+            }
+          }
+          else
+          {
+            tClaimConflictCounter::Increment();
+          }
+        }
+      }
+    }
+    return obtained;
+  }
+
   template <bool MULTIPLE_READERS = cMULTIPLE_READERS>
   bool MarkBufferUsed(tArrayElement& array_element, typename std::enable_if < !MULTIPLE_READERS, T >::type* buffer)
   {
@@ -222,6 +729,67 @@ private:
     return array_element.compare_exchange_strong(buffer, NULL);
   }
 
+  template <typename U>
+  static inline U LoadRelaxed(const U& value)
+  {
+    return value;
+  }
+  template <typename U>
+  static inline U LoadRelaxed(const std::atomic<U>& value)
+  {
+    return value.load(std::memory_order_relaxed);
+  }
+
+  template <typename U>
+  static inline U LoadAcquire(const U& value)
+  {
+    return value;
+  }
+  template <typename U>
+  static inline U LoadAcquire(const std::atomic<U>& value)
+  {
+    return value.load(std::memory_order_acquire);
+  }
+
+  template <typename U>
+  static inline void StoreRelaxed(U& variable, U value)
+  {
+    variable = value;
+  }
+  template <typename U>
+  static inline void StoreRelaxed(std::atomic<U>& variable, U value)
+  {
+    variable.store(value, std::memory_order_relaxed);
+  }
+
+  static inline int FetchAdd(int& variable, int value)
+  {
+    int result = variable;
+    variable += value;
+    return result;
+  }
+  static inline int FetchAdd(std::atomic<int>& variable, int value)
+  {
+    return variable.fetch_add(value);
+  }
+
+  template <typename U>
+  static inline bool CompareExchange(U& variable, U& expected, U desired)
+  {
+    if (variable == expected)
+    {
+      variable = desired;
+      return true;
+    }
+    expected = variable;
+    return false;
+  }
+  template <typename U>
+  static inline bool CompareExchange(std::atomic<U>& variable, U& expected, U desired)
+  {
+    return variable.compare_exchange_strong(expected, desired);
+  }
+
   static inline void NotifyOnRecycle(void*) {}
   static inline void NotifyOnRecycle(tNotifyOnRecycle* recycled)
   {
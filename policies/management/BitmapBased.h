@@ -0,0 +1,504 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/policies/management/BitmapBased.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains BitmapBased
+ *
+ * \b BitmapBased
+ *
+ * Buffers are stored in chunks of 64 buffers.
+ * Whether buffers are in use is signaled by one bit in a 64-bit word per chunk.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__policies__management__BitmapBased_h__
+#define __rrlib__buffer_pools__policies__management__BitmapBased_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/thread/tThread.h"
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tClaimConflictCounter.h"
+#include "rrlib/buffer_pools/tNotifyOnRecycle.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+namespace management
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Bitmap-based buffer management
+/*!
+ * Buffers are stored in a linked list of chunks with 64 buffers each.
+ * Every chunk has a 64-bit occupancy word - with one bit set for every unused buffer.
+ * An unused buffer is found with count-trailing-zeros and claimed with a single
+ * atomic fetch_and on this word.
+ *
+ * Slots of buffers removed by RemoveUnusedBuffers are reused by AddBuffer (lowest slot first).
+ * Chunks without any buffers left are deleted - if there is a single reader only
+ * (RemoveUnusedBuffers must be called by reader thread then).
+ * With multiple readers, concurrent readers might still access such a chunk - so it is kept to be reused when the pool grows again.
+ *
+ * Pro: Any type T can be used. Scales well with many buffers (64 buffers are checked with a single operation).
+ * Con: Memory is allocated in chunks of 64 buffers.
+ *
+ * TAddMutex Mutex to protect AddBuffer operation with (may be tNoMutex if concurrent adding does not occur)
+ */
+template < typename T,
+         concurrent_containers::tConcurrency CONCURRENCY,
+         typename TBufferDeleter,
+         typename TAddMutex = typename std::conditional < (CONCURRENCY == concurrent_containers::tConcurrency::FULL) || (CONCURRENCY == concurrent_containers::tConcurrency::MULTIPLE_READERS), thread::tMutex, thread::tNoMutex >::type >
+class BitmapBased : public TAddMutex
+{
+  enum { cMULTIPLE_READERS = (CONCURRENCY == concurrent_containers::tConcurrency::FULL) || (CONCURRENCY == concurrent_containers::tConcurrency::MULTIPLE_READERS) };
+  enum { cATOMIC_OCCUPANCY_WORDS = (CONCURRENCY != concurrent_containers::tConcurrency::NONE) };
+  enum { cCHUNK_SIZE = 64 };
+  enum { cCHUNK_ALIGNMENT = 64 }; // chunk addresses have 6 free low bits to store buffer index in buffer_management_info
+
+  typedef typename std::conditional<cATOMIC_OCCUPANCY_WORDS, std::atomic<uint64_t>, uint64_t>::type tOccupancyWord;
+  struct tChunk;
+  typedef typename std::conditional<cMULTIPLE_READERS, std::atomic<tChunk*>, tChunk*>::type tNextChunkPointer;
+  typedef typename std::conditional<cMULTIPLE_READERS, std::atomic<int>, int>::type tBufferCount;
+
+  /*! Chunk with 64 buffers */
+  struct tChunk
+  {
+    /*! Bit i is set if buffers[i] is unused */
+    tOccupancyWord unused_buffers;
+
+    /*! Buffers in chunk. Set once when buffer is added. */
+    std::array<T*, cCHUNK_SIZE> buffers;
+
+    /*! Pointer to next chunk -> linked-list */
+    tNextChunkPointer next_chunk;
+
+    /*! Buffer management object of pool that chunk belongs to */
+    BitmapBased* const owner;
+
+    /*! Bit i is set if slot i is not assigned to any buffer (protected by mutex) */
+    uint64_t free_slots;
+
+    tChunk(BitmapBased* owner) : unused_buffers(0), buffers(), next_chunk(NULL), owner(owner), free_slots(~static_cast<uint64_t>(0)) {}
+
+    ~tChunk()
+    {
+      tChunk* next = next_chunk;
+      delete next;
+    }
+
+    static void* operator new(size_t size)
+    {
+      void* result = NULL;
+      if (posix_memalign(&result, cCHUNK_ALIGNMENT, size))
+      {
+        throw std::bad_alloc();
+      }
+      return result;
+    }
+
+    static void operator delete(void* chunk)
+    {
+      free(chunk);
+    }
+  };
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  BitmapBased() :
+    first_chunk(new tChunk(this)), first_chunk_with_free_slots(first_chunk), buffer_count(0)
+  {}
+
+  ~BitmapBased()
+  {
+    delete first_chunk;
+  }
+
+  void AddBuffer(T* buffer, tBufferManagementInfo& info)
+  {
+    thread::tLock lock(*this);
+    tChunk* chunk = first_chunk_with_free_slots;
+    while (!chunk->free_slots)
+    {
+      chunk = GetOrCreateNextChunk(*chunk);
+    }
+    first_chunk_with_free_slots = chunk;
+    int index = __builtin_ctzll(chunk->free_slots);
+    chunk->free_slots &= chunk->free_slots - 1;
+    chunk->buffers[index] = buffer;
+    info.buffer_management_info = EncodeManagementInfo(*chunk, index); // bit is set by recycler
+    buffer_count = buffer_count + 1; // safe due to lock
+  }
+
+  /*!
+   * Prepares management structures for the specified number of additional buffers
+   *
+   * \param additional_buffers Number of buffers that are about to be added
+   */
+  void Reserve(size_t additional_buffers)
+  {
+    thread::tLock lock(*this);
+    tChunk* chunk = first_chunk_with_free_slots;
+    for (size_t free_slots = __builtin_popcountll(chunk->free_slots); free_slots < additional_buffers; free_slots += __builtin_popcountll(chunk->free_slots))
+    {
+      chunk = GetOrCreateNextChunk(*chunk);
+    }
+  }
+
+  /*!
+   * \return Number of buffers that have not been returned yet
+   */
+  int DeleteGarbage()
+  {
+    thread::tLock lock(*this); // should not be necessary, if pool is used sensibly, but does not hurt
+    for (tChunk* current = first_chunk; current; current = current->next_chunk)
+    {
+      uint64_t unused = FetchAnd(current->unused_buffers, 0);
+      while (unused)
+      {
+        int index = __builtin_ctzll(unused);
+        unused &= unused - 1;
+        TBufferDeleter deleter;
+        deleter(current->buffers[index]);
+        this->buffer_count--;
+      }
+    }
+    return this->buffer_count;
+  }
+
+  /*!
+   * \return Number of buffers in this pool (including buffers in use)
+   */
+  size_t GetBufferCount()
+  {
+    thread::tLock lock(*this);
+    return buffer_count;
+  }
+
+  /*!
+   * Determines number of unused buffers without obtaining them (e.g. for trimming idle buffers).
+   * Buffers may be obtained and recycled concurrently - so the result is a snapshot only.
+   *
+   * \return Number of unused buffers in this pool
+   */
+  size_t GetUnusedBufferCount()
+  {
+    size_t count = 0;
+    for (tChunk* current = first_chunk; current; current = current->next_chunk)
+    {
+      count += __builtin_popcountll(Load(current->unused_buffers));
+    }
+    return count;
+  }
+
+  T* GetUnusedBuffer(tBufferManagementInfo& info)
+  {
+    for (tChunk* current = first_chunk; current; current = current->next_chunk)
+    {
+      uint64_t unused = Load(current->unused_buffers);
+      while (unused)
+      {
+        uint64_t bit = unused & (~unused + 1); // lowest set bit
+        uint64_t previous = FetchAnd(current->unused_buffers, ~bit);
+        if (previous & bit)
+        {
+          int index = __builtin_ctzll(bit);
+          info.buffer_management_info = EncodeManagementInfo(*current, index);
+          return current->buffers[index];
+        }
+        tClaimConflictCounter::Increment();
+        unused = previous & ~bit; // another reader was faster: retry with remaining bits
+      }
+    }
+    info.buffer_management_info = NULL;
+    return NULL;
+  }
+
+  /*!
+   * Obtains up to count unused buffers in one operation
+   *
+   * \param count Maximum number of buffers to obtain
+   * \param function Function (T* buffer, const tBufferManagementInfo& info) to call for every buffer obtained
+   * \return Number of buffers obtained
+   */
+  template <typename TFunction>
+  size_t GetUnusedBuffers(size_t count, TFunction function)
+  {
+    tBufferManagementInfo info;
+    size_t obtained = 0;
+    for (tChunk* current = first_chunk; current && obtained < count; current = current->next_chunk)
+    {
+      uint64_t unused = Load(current->unused_buffers);
+      while (unused && obtained < count)
+      {
+        uint64_t claim = LowestSetBits(unused, count - obtained); // claim up to all remaining buffers with a single operation
+        uint64_t previous = FetchAnd(current->unused_buffers, ~claim);
+        uint64_t claimed = previous & claim;
+        if (claimed != claim)
+        {
+          tClaimConflictCounter::Increment();
+        }
+        while (claimed)
+        {
+          int index = __builtin_ctzll(claimed);
+          claimed &= claimed - 1;
+          info.buffer_management_info = EncodeManagementInfo(*current, index);
+          function(current->buffers[index], info);
+          obtained++;
+        }
+        unused = previous & ~claim;
+      }
+    }
+    return obtained;
+  }
+
+  /*!
+   * Removes up to count unused buffers from this pool and deletes them.
+   * Their slots are reused by AddBuffer. Chunks without any buffers left are deleted with a single reader (see class documentation).
+   *
+   * \param count Maximum number of buffers to remove
+   * \return Number of buffers removed
+   */
+  size_t RemoveUnusedBuffers(size_t count)
+  {
+    thread::tLock lock(*this);
+    size_t removed = 0;
+    bool passed_first_chunk_with_free_slots = false;
+    for (tChunk* previous = NULL, *current = first_chunk; current && removed < count; previous = current, current = current->next_chunk)
+    {
+      passed_first_chunk_with_free_slots |= (current == first_chunk_with_free_slots);
+      uint64_t claim = LowestSetBits(Load(current->unused_buffers), count - removed);
+      if (!claim)
+      {
+        continue;
+      }
+      uint64_t claimed = FetchAnd(current->unused_buffers, ~claim) & claim;
+      if (claimed && !passed_first_chunk_with_free_slots)
+      {
+        first_chunk_with_free_slots = current;
+        passed_first_chunk_with_free_slots = true;
+      }
+      current->free_slots |= claimed;
+      while (claimed)
+      {
+        int index = __builtin_ctzll(claimed);
+        claimed &= claimed - 1;
+        TBufferDeleter deleter;
+        deleter(current->buffers[index]);
+        current->buffers[index] = NULL;
+        buffer_count = buffer_count - 1; // safe due to lock
+        removed++;
+      }
+
+      if ((!cMULTIPLE_READERS) && previous && current->free_slots == ~static_cast<uint64_t>(0)) // delete empty chunk (no other thread accesses it)
+      {
+        if (first_chunk_with_free_slots == current)
+        {
+          first_chunk_with_free_slots = previous;
+        }
+        previous->next_chunk = static_cast<tChunk*>(current->next_chunk);
+        current->next_chunk = NULL;
+        delete current;
+        current = previous;
+      }
+    }
+    return removed;
+  }
+
+  /*!
+   * \return Number of chunks in linked list
+   */
+  size_t GetChunkCount()
+  {
+    thread::tLock lock(*this);
+    size_t count = 0;
+    for (tChunk* current = first_chunk; current; current = current->next_chunk)
+    {
+      count++;
+    }
+    return count;
+  }
+
+  /*!
+   * \param info Buffer management info of a buffer (obtained from a pool with this policy)
+   * \return Buffer management object of pool that buffer belongs to
+   */
+  static BitmapBased* GetOwner(const tBufferManagementInfo& info)
+  {
+    return GetChunk(info)->owner;
+  }
+
+  static void RecycleBuffer(const tBufferManagementInfo& info, T* buffer)
+  {
+    assert(info.buffer_management_info && "Received empty buffer_management_info. This is not allowed using this policy.");
+    uintptr_t encoded = reinterpret_cast<uintptr_t>(info.buffer_management_info);
+    NotifyOnRecycle(buffer);
+    FetchOr(GetChunk(info)->unused_buffers, static_cast<uint64_t>(1) << (encoded & (cCHUNK_ALIGNMENT - 1)));
+  }
+
+  /*!
+   * Recycles multiple buffers in one operation
+   * (buffers may originate from different pools)
+   *
+   * \param buffers Buffers to recycle together with their buffer management info
+   * \param count Number of buffers
+   */
+  static void RecycleBuffers(const std::pair<tBufferManagementInfo, T*>* buffers, size_t count)
+  {
+    for (size_t i = 0; i < count;)
+    {
+      assert(buffers[i].first.buffer_management_info && "Received empty buffer_management_info. This is not allowed using this policy.");
+      uintptr_t encoded = reinterpret_cast<uintptr_t>(buffers[i].first.buffer_management_info);
+      uintptr_t chunk_address = encoded & ~static_cast<uintptr_t>(cCHUNK_ALIGNMENT - 1);
+      uint64_t recycled = 0;
+      for (; i < count && (reinterpret_cast<uintptr_t>(buffers[i].first.buffer_management_info) & ~static_cast<uintptr_t>(cCHUNK_ALIGNMENT - 1)) == chunk_address; i++)
+      {
+        NotifyOnRecycle(buffers[i].second);
+        recycled |= static_cast<uint64_t>(1) << (reinterpret_cast<uintptr_t>(buffers[i].first.buffer_management_info) & (cCHUNK_ALIGNMENT - 1));
+      }
+      FetchOr(reinterpret_cast<tChunk*>(chunk_address)->unused_buffers, recycled); // single operation for all consecutive buffers from the same chunk
+    }
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! First chunk in linked list */
+  tChunk* const first_chunk;
+
+  /*! No chunk before this one has free slots (protected by mutex) */
+  tChunk* first_chunk_with_free_slots;
+
+  /*! Number of buffers in this pool */
+  tBufferCount buffer_count;
+
+  /*!
+   * \return Chunk after specified chunk in linked list. Is created if it does not exist yet. (mutex must be locked)
+   */
+  tChunk* GetOrCreateNextChunk(tChunk& chunk)
+  {
+    tChunk* next = chunk.next_chunk;
+    if (!next)
+    {
+      next = new tChunk(this);
+      chunk.next_chunk = next;
+    }
+    return next;
+  }
+
+  static void* EncodeManagementInfo(tChunk& chunk, int index)
+  {
+    return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(&chunk) | static_cast<uintptr_t>(index));
+  }
+
+  static tChunk* GetChunk(const tBufferManagementInfo& info)
+  {
+    return reinterpret_cast<tChunk*>(reinterpret_cast<uintptr_t>(info.buffer_management_info) & ~static_cast<uintptr_t>(cCHUNK_ALIGNMENT - 1));
+  }
+
+  /*!
+   * \return Word with only the n lowest set bits of the specified word set
+   */
+  static uint64_t LowestSetBits(uint64_t word, size_t n)
+  {
+    uint64_t result = 0;
+    for (; word && n > 0; n--)
+    {
+      uint64_t bit = word & (~word + 1);
+      result |= bit;
+      word &= ~bit;
+    }
+    return result;
+  }
+
+  static inline uint64_t Load(const uint64_t& word)
+  {
+    return word;
+  }
+  static inline uint64_t Load(const std::atomic<uint64_t>& word)
+  {
+    return word.load(std::memory_order_relaxed);
+  }
+
+  static inline uint64_t FetchAnd(uint64_t& word, uint64_t mask)
+  {
+    uint64_t previous = word;
+    word &= mask;
+    return previous;
+  }
+  static inline uint64_t FetchAnd(std::atomic<uint64_t>& word, uint64_t mask)
+  {
+    return word.fetch_and(mask, std::memory_order_acquire);
+  }
+
+  static inline void FetchOr(uint64_t& word, uint64_t mask)
+  {
+    word |= mask;
+  }
+  static inline void FetchOr(std::atomic<uint64_t>& word, uint64_t mask)
+  {
+    word.fetch_or(mask, std::memory_order_release);
+  }
+
+  static inline void NotifyOnRecycle(void*) {}
+  static inline void NotifyOnRecycle(tNotifyOnRecycle* recycled)
+  {
+    static_cast<T*>(recycled)->OnRecycle();
+  }
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+
+#endif
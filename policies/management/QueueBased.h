@@ -40,6 +40,7 @@
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
 #include "rrlib/concurrent_containers/tQueue.h"
+#include <algorithm>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
@@ -68,7 +69,9 @@ namespace management
  * Buffer management based on collecting unused buffers in a concurrent queue.
  *
  * Pro: Scales well with many buffers
- * Con: Types T must be queueable => memory overhead & possibly difficult to achieve
+ * Con: Types T must be queueable => memory overhead & possibly difficult to achieve.
+ *      Queue provides no bulk dequeue - so there is no GetUnusedBuffers() operation
+ *      (tBufferPool::GetUnusedBuffers() obtains buffers one by one).
  */
 template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename TBufferDeleter>
 class QueueBased
@@ -94,17 +97,49 @@ class QueueBased
 //----------------------------------------------------------------------
 public:
 
+  /*! Queue provides no bulk dequeue (see tBufferPool::GetUnusedBuffers) */
+  enum { cNO_BATCH_ACQUISITION = true };
+
   QueueBased() :
     unused_buffers(),
-    buffer_count(0)
+    buffer_count(0),
+    enqueued_buffer_count(0)
   {}
 
+  /*!
+   * Transfers a buffer in use from another pool of the same type to this pool
+   * (buffer is recycled into this pool from now on)
+   *
+   * \param buffer Buffer to transfer
+   * \param info Buffer management info of buffer (refers to previous owner). Is updated to refer to this pool.
+   */
+  void AdoptBuffer(T* buffer, tBufferManagementInfo& info)
+  {
+    QueueBased* previous_owner = static_cast<QueueBased*>(info.buffer_management_info);
+    if (previous_owner != this)
+    {
+      previous_owner->buffer_count--;
+      buffer_count++;
+      info.buffer_management_info = this;
+    }
+  }
+
   void AddBuffer(T* buffer, tBufferManagementInfo& info)
   {
     buffer_count++;
     info.buffer_management_info = this;
   }
 
+  /*!
+   * Prepares management structures for the specified number of additional buffers
+   *
+   * \param additional_buffers Number of buffers that are about to be added
+   */
+  void Reserve(size_t additional_buffers)
+  {
+    // queue does not need any preparation
+  }
+
   /*!
    * \return Number of buffers that have not been returned yet
    */
@@ -118,15 +153,68 @@ public:
       {
         break;
       }
+      enqueued_buffer_count--;
       buffer_count--;
     }
     return buffer_count - tQueueType::cMINIMUM_ELEMENTS_IN_QEUEUE;
   }
 
+  /*!
+   * \return Number of buffers in this pool (including buffers in use)
+   */
+  size_t GetBufferCount()
+  {
+    return buffer_count.load();
+  }
+
+  /*!
+   * Determines number of unused buffers without obtaining them (e.g. for trimming idle buffers).
+   * Buffers may be obtained and recycled concurrently - so the result is a snapshot only.
+   *
+   * \return Number of unused buffers in this pool
+   */
+  size_t GetUnusedBufferCount()
+  {
+    int unused = enqueued_buffer_count.load(std::memory_order_relaxed) - tQueueType::cMINIMUM_ELEMENTS_IN_QEUEUE; // fast queue retains one element
+    return std::max(unused, 0);
+  }
+
   T* GetUnusedBuffer(tBufferManagementInfo& info)
   {
     info.buffer_management_info = this;
-    return unused_buffers.Dequeue().release();
+    return Dequeue();
+  }
+
+  /*!
+   * \param info Buffer management info of a buffer (obtained from a pool with this policy)
+   * \return Buffer management object of pool that buffer belongs to
+   */
+  static QueueBased* GetOwner(const tBufferManagementInfo& info)
+  {
+    return static_cast<QueueBased*>(info.buffer_management_info);
+  }
+
+  /*!
+   * Removes up to count unused buffers from this pool and deletes them
+   *
+   * \param count Maximum number of buffers to remove
+   * \return Number of buffers removed
+   */
+  size_t RemoveUnusedBuffers(size_t count)
+  {
+    size_t removed = 0;
+    for (; removed < count; removed++)
+    {
+      T* buffer = Dequeue();
+      if (!buffer)
+      {
+        break;
+      }
+      TBufferDeleter deleter;
+      deleter(buffer);
+    }
+    buffer_count -= removed;
+    return removed;
   }
 
   static void RecycleBuffer(const tBufferManagementInfo& info, T* buffer)
@@ -134,9 +222,26 @@ public:
     assert(info.buffer_management_info && "Received empty buffer_management_info. This is not allowed using this policy.");
     QueueBased* owner_pool = static_cast<QueueBased*>(info.buffer_management_info);
     NotifyOnRecycle(buffer);
+    owner_pool->enqueued_buffer_count.fetch_add(1, std::memory_order_relaxed); // pool might be deleted after enqueueing
     owner_pool->unused_buffers.Enqueue(tQueuePointer(buffer));
   }
 
+  /*!
+   * Recycles multiple buffers in one operation
+   * (buffers may originate from different pools)
+   *
+   * \param buffers Buffers to recycle together with their buffer management info
+   * \param count Number of buffers
+   */
+  static void RecycleBuffers(const std::pair<tBufferManagementInfo, T*>* buffers, size_t count)
+  {
+    // tQueue has no operation to enqueue a chain of elements
+    for (size_t i = 0; i < count; i++)
+    {
+      RecycleBuffer(buffers[i].first, buffers[i].second);
+    }
+  }
+
 //----------------------------------------------------------------------
 // Private fields and methods
 //----------------------------------------------------------------------
@@ -148,6 +253,22 @@ private:
   /*! Number of buffers in this pool */
   std::atomic<int> buffer_count;
 
+  /*! Number of buffers in queue (incremented before enqueueing and decremented after dequeueing - so that it is never negative) */
+  std::atomic<int> enqueued_buffer_count;
+
+
+  /*!
+   * \return Buffer dequeued from queue of unused buffers - NULL if there is none
+   */
+  T* Dequeue()
+  {
+    T* buffer = unused_buffers.Dequeue().release();
+    if (buffer)
+    {
+      enqueued_buffer_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return buffer;
+  }
 
   static inline void NotifyOnRecycle(void*) {}
   static inline void NotifyOnRecycle(tNotifyOnRecycle* recycled)
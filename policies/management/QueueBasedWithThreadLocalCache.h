@@ -0,0 +1,622 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/policies/management/QueueBasedWithThreadLocalCache.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains QueueBasedWithThreadLocalCache
+ *
+ * \b QueueBasedWithThreadLocalCache
+ *
+ * Buffer management based on collecting unused buffers in a concurrent queue.
+ * Each thread keeps a small magazine of unused buffers in front of this queue.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__policies__management__QueueBasedWithThreadLocalCache_h__
+#define __rrlib__buffer_pools__policies__management__QueueBasedWithThreadLocalCache_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/concurrent_containers/tQueue.h"
+#include <algorithm>
+#include "rrlib/thread/tThread.h"
+#include <array>
+#include <vector>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tNotifyOnRecycle.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+namespace management
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Queue-based buffer management with thread-local magazines
+/*!
+ * Buffer management based on collecting unused buffers in a concurrent queue -
+ * like QueueBased.
+ * In addition, every thread keeps a small magazine of unused buffers per pool.
+ * Buffers are obtained from and recycled to this magazine.
+ * Only if the magazine is empty or full, buffers are moved from or to the shared
+ * queue - in batches of cTRANSFER_BATCH_SIZE buffers.
+ * Thus, the steady-state acquire/recycle path does not touch any cache lines shared with other threads.
+ * When a thread exits, the buffers in its magazines are returned to the shared queues.
+ * Magazines are only created for threads that obtain buffers from a pool.
+ * Other threads recycle buffers to the shared queue directly.
+ * If a thread finds neither buffers in its magazine nor in the shared queue, it takes buffers
+ * from the magazines of other threads (slow path - involving a mutex). So no thread starves
+ * while unused buffers are kept in magazines of other threads.
+ *
+ * Pro: Scales well with many buffers and many threads
+ * Con: Types T must be queueable. Acquiring buffers from an exhausted pool involves a mutex.
+ */
+template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename TBufferDeleter>
+class QueueBasedWithThreadLocalCache
+{
+
+  static_assert(std::is_base_of<concurrent_containers::queue::tQueueableMost, T>::value ||
+                (CONCURRENCY == concurrent_containers::tConcurrency::NONE && std::is_base_of<concurrent_containers::queue::tQueueableSingleThreaded, T>::value),
+                "Only queueable types may be used with queue-based policy. Choosing UseBufferContainer Recycling policy might be an alternative.");
+
+  enum { cMAGAZINE_SIZE = 16 };
+  enum { cTRANSFER_BATCH_SIZE = cMAGAZINE_SIZE / 2 };
+
+  /*! Pointer type used in internal queue (we don't want any auto-recycling here) */
+  typedef std::unique_ptr<T, TBufferDeleter> tQueuePointer;
+
+  /*! Type of queue backend (see QueueBased) */
+  typedef concurrent_containers::tQueue<tQueuePointer, CONCURRENCY, concurrent_containers::tDequeueMode::FIFO_FAST> tQueueType;
+
+  /*!
+   * Magazine of one thread for one pool.
+   * Allocated and deleted by its thread. Only accessed by other threads while pool is deleted.
+   */
+  struct tMagazine
+  {
+    /*! Pool that this magazine belongs to. NULL if pool has been deleted. */
+    std::atomic<QueueBasedWithThreadLocalCache*> owner;
+
+    /*! Set while magazine is accessed. Only contended when pool's garbage is deleted. */
+    std::atomic<bool> locked;
+
+    /*! Number of buffers in magazine */
+    size_t count;
+
+    /*! Buffers in magazine */
+    std::array<T*, cMAGAZINE_SIZE> buffers;
+
+    /*! Next magazine in owner's list of magazines (protected by RegistryMutex()) */
+    tMagazine* next_magazine;
+
+    tMagazine(QueueBasedWithThreadLocalCache* owner) : owner(owner), locked(false), count(0), buffers(), next_magazine(NULL) {}
+
+    void Lock()
+    {
+      while (locked.exchange(true, std::memory_order_acquire));
+    }
+
+    void Unlock()
+    {
+      locked.store(false, std::memory_order_release);
+    }
+  };
+
+  /*! Magazines of current thread. Returns buffers to their pools on thread exit. */
+  struct tThreadMagazines
+  {
+    std::vector<tMagazine*> magazines;
+
+    ~tThreadMagazines()
+    {
+      thread::tLock lock(RegistryMutex());
+      for (auto it = magazines.begin(); it != magazines.end(); ++it)
+      {
+        QueueBasedWithThreadLocalCache* owner = (*it)->owner.load(std::memory_order_relaxed);
+        if (owner)
+        {
+          owner->FlushMagazine(**it, 0);
+          owner->RemoveMagazine(*it);
+        }
+        delete *it;
+      }
+    }
+  };
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  QueueBasedWithThreadLocalCache() :
+    unused_buffers(),
+    buffer_count(0),
+    enqueued_buffer_count(0),
+    closed(false),
+    queue_used(false),
+    first_magazine(NULL)
+  {}
+
+  ~QueueBasedWithThreadLocalCache()
+  {
+    thread::tLock lock(RegistryMutex());
+    for (tMagazine* magazine = first_magazine; magazine; magazine = magazine->next_magazine)
+    {
+      magazine->owner.store(NULL, std::memory_order_relaxed); // thread will delete magazine
+    }
+  }
+
+  /*!
+   * Transfers a buffer in use from another pool of the same type to this pool
+   * (buffer is recycled into this pool from now on)
+   *
+   * \param buffer Buffer to transfer
+   * \param info Buffer management info of buffer (refers to previous owner). Is updated to refer to this pool.
+   */
+  void AdoptBuffer(T* buffer, tBufferManagementInfo& info)
+  {
+    QueueBasedWithThreadLocalCache* previous_owner = static_cast<QueueBasedWithThreadLocalCache*>(info.buffer_management_info);
+    if (previous_owner != this)
+    {
+      previous_owner->buffer_count--;
+      buffer_count++;
+      info.buffer_management_info = this;
+    }
+  }
+
+  void AddBuffer(T* buffer, tBufferManagementInfo& info)
+  {
+    buffer_count++;
+    info.buffer_management_info = this;
+  }
+
+  /*!
+   * Prepares management structures for the specified number of additional buffers
+   *
+   * \param additional_buffers Number of buffers that are about to be added
+   */
+  void Reserve(size_t additional_buffers)
+  {
+    // queue does not need any preparation
+  }
+
+  /*!
+   * \return Number of buffers that have not been returned yet
+   */
+  int DeleteGarbage()
+  {
+    {
+      thread::tLock lock(RegistryMutex());
+      closed.store(true); // from now on, buffers are recycled to queue directly
+      for (tMagazine* magazine = first_magazine; magazine; magazine = magazine->next_magazine)
+      {
+        magazine->Lock();
+        for (size_t i = 0; i < magazine->count; i++)
+        {
+          TBufferDeleter deleter;
+          deleter(magazine->buffers[i]);
+          buffer_count--;
+        }
+        magazine->count = 0;
+        magazine->Unlock();
+      }
+    }
+
+    bool success = true;
+    while (true)
+    {
+      unused_buffers.Dequeue(success);
+      if (!success)
+      {
+        break;
+      }
+      enqueued_buffer_count--;
+      buffer_count--;
+    }
+    return buffer_count - (queue_used.load() ? tQueueType::cMINIMUM_ELEMENTS_IN_QEUEUE : 0);
+  }
+
+  /*!
+   * \return Number of buffers in this pool (including buffers in use)
+   */
+  size_t GetBufferCount()
+  {
+    return buffer_count.load();
+  }
+
+  /*!
+   * Determines number of unused buffers without obtaining them (e.g. for trimming idle buffers).
+   * Includes buffers in the magazines of all threads.
+   * Buffers may be obtained and recycled concurrently - so the result is a snapshot only.
+   *
+   * \return Number of unused buffers in this pool
+   */
+  size_t GetUnusedBufferCount()
+  {
+    int unused = std::max(enqueued_buffer_count.load(std::memory_order_relaxed) - (queue_used.load() ? tQueueType::cMINIMUM_ELEMENTS_IN_QEUEUE : 0), 0);
+    thread::tLock lock(RegistryMutex());
+    for (tMagazine* magazine = first_magazine; magazine; magazine = magazine->next_magazine)
+    {
+      magazine->Lock();
+      unused += static_cast<int>(magazine->count);
+      magazine->Unlock();
+    }
+    return unused;
+  }
+
+  T* GetUnusedBuffer(tBufferManagementInfo& info)
+  {
+    info.buffer_management_info = this;
+    tMagazine& magazine = GetMagazine();
+    magazine.Lock();
+    if (magazine.count == 0)
+    {
+      for (; magazine.count < cTRANSFER_BATCH_SIZE; magazine.count++)
+      {
+        T* buffer = Dequeue();
+        if (!buffer)
+        {
+          break;
+        }
+        magazine.buffers[magazine.count] = buffer;
+      }
+    }
+    T* result = magazine.count ? magazine.buffers[--magazine.count] : NULL;
+    magazine.Unlock();
+    if (!result)
+    {
+      StealBuffers(1, [&result](T * buffer, const tBufferManagementInfo&)
+      {
+        result = buffer;
+      }, info);
+    }
+    return result;
+  }
+
+  /*!
+   * \param info Buffer management info of a buffer (obtained from a pool with this policy)
+   * \return Buffer management object of pool that buffer belongs to
+   */
+  static QueueBasedWithThreadLocalCache* GetOwner(const tBufferManagementInfo& info)
+  {
+    return static_cast<QueueBasedWithThreadLocalCache*>(info.buffer_management_info);
+  }
+
+  /*!
+   * Obtains up to count unused buffers in one operation
+   *
+   * \param count Maximum number of buffers to obtain
+   * \param function Function (T* buffer, const tBufferManagementInfo& info) to call for every buffer obtained
+   * \return Number of buffers obtained
+   */
+  template <typename TFunction>
+  size_t GetUnusedBuffers(size_t count, TFunction function)
+  {
+    tBufferManagementInfo info;
+    info.buffer_management_info = this;
+    tMagazine& magazine = GetMagazine();
+    magazine.Lock();
+    size_t obtained = 0;
+    for (; obtained < count; obtained++)
+    {
+      T* buffer = magazine.count ? magazine.buffers[--magazine.count] : Dequeue();
+      if (!buffer)
+      {
+        break;
+      }
+      function(buffer, info);
+    }
+    magazine.Unlock();
+    if (obtained < count)
+    {
+      obtained += StealBuffers(count - obtained, function, info);
+    }
+    return obtained;
+  }
+
+  /*!
+   * Removes up to count unused buffers from this pool and deletes them
+   *
+   * \param count Maximum number of buffers to remove
+   * \return Number of buffers removed
+   */
+  size_t RemoveUnusedBuffers(size_t count)
+  {
+    size_t removed = GetUnusedBuffers(count, [](T * buffer, const tBufferManagementInfo&)
+    {
+      TBufferDeleter deleter;
+      deleter(buffer);
+    });
+    buffer_count -= removed;
+    return removed;
+  }
+
+  static void RecycleBuffer(const tBufferManagementInfo& info, T* buffer)
+  {
+    assert(info.buffer_management_info && "Received empty buffer_management_info. This is not allowed using this policy.");
+    QueueBasedWithThreadLocalCache* owner_pool = static_cast<QueueBasedWithThreadLocalCache*>(info.buffer_management_info);
+    NotifyOnRecycle(buffer);
+    tMagazine* magazine = owner_pool->FindMagazine();
+    if (!magazine)
+    {
+      owner_pool->EnqueueBuffer(buffer); // thread does not obtain buffers from this pool
+      return;
+    }
+    magazine->Lock();
+    if (owner_pool->closed.load(std::memory_order_relaxed))
+    {
+      magazine->Unlock();
+      owner_pool->EnqueueBuffer(buffer);
+      return;
+    }
+    if (magazine->count == cMAGAZINE_SIZE)
+    {
+      owner_pool->FlushMagazine(*magazine, cMAGAZINE_SIZE - cTRANSFER_BATCH_SIZE);
+    }
+    magazine->buffers[magazine->count] = buffer;
+    magazine->count++;
+    magazine->Unlock();
+  }
+
+  /*!
+   * Recycles multiple buffers in one operation
+   * (buffers may originate from different pools)
+   *
+   * \param buffers Buffers to recycle together with their buffer management info
+   * \param count Number of buffers
+   */
+  static void RecycleBuffers(const std::pair<tBufferManagementInfo, T*>* buffers, size_t count)
+  {
+    for (size_t i = 0; i < count;)
+    {
+      assert(buffers[i].first.buffer_management_info && "Received empty buffer_management_info. This is not allowed using this policy.");
+      QueueBasedWithThreadLocalCache* owner_pool = static_cast<QueueBasedWithThreadLocalCache*>(buffers[i].first.buffer_management_info);
+      tMagazine* magazine = owner_pool->FindMagazine(); // NULL if thread does not obtain buffers from this pool
+      if (magazine)
+      {
+        magazine->Lock();
+      }
+      bool enqueue = (!magazine) || owner_pool->closed.load(std::memory_order_relaxed);
+      for (; i < count && buffers[i].first.buffer_management_info == owner_pool; i++) // all consecutive buffers from the same pool
+      {
+        T* buffer = buffers[i].second;
+        NotifyOnRecycle(buffer);
+        if (enqueue)
+        {
+          owner_pool->EnqueueBuffer(buffer);
+          continue;
+        }
+        if (magazine->count == cMAGAZINE_SIZE)
+        {
+          owner_pool->FlushMagazine(*magazine, cMAGAZINE_SIZE - cTRANSFER_BATCH_SIZE);
+        }
+        magazine->buffers[magazine->count] = buffer;
+        magazine->count++;
+      }
+      if (magazine)
+      {
+        magazine->Unlock();
+      }
+    }
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Queue containing the unused buffers of this pool that are not in any magazine */
+  tQueueType unused_buffers;
+
+  /*! Number of buffers in this pool */
+  std::atomic<int> buffer_count;
+
+  /*! Number of buffers in shared queue (incremented before enqueueing and decremented after dequeueing - so that it is never negative) */
+  std::atomic<int> enqueued_buffer_count;
+
+  /*! True once DeleteGarbage() has been called (pool has been deleted) */
+  std::atomic<bool> closed;
+
+  /*! True once any buffer has been enqueued in shared queue (a fast queue always retains one element from then on) */
+  std::atomic<bool> queue_used;
+
+  /*! First magazine in linked list of all magazines of this pool (protected by RegistryMutex()) */
+  tMagazine* first_magazine;
+
+
+  /*!
+   * Moves buffers from magazine to shared queue
+   *
+   * \param magazine Magazine (must be locked or owned by current thread)
+   * \param keep Number of buffers to keep in magazine
+   */
+  void FlushMagazine(tMagazine& magazine, size_t keep)
+  {
+    while (magazine.count > keep)
+    {
+      magazine.count--;
+      EnqueueBuffer(magazine.buffers[magazine.count]);
+    }
+  }
+
+  void EnqueueBuffer(T* buffer)
+  {
+    if (!queue_used.load(std::memory_order_relaxed))
+    {
+      queue_used.store(true);
+    }
+    enqueued_buffer_count.fetch_add(1, std::memory_order_relaxed);
+    unused_buffers.Enqueue(tQueuePointer(buffer));
+  }
+
+  /*!
+   * \return Buffer dequeued from shared queue - NULL if there is none
+   */
+  T* Dequeue()
+  {
+    T* buffer = unused_buffers.Dequeue().release();
+    if (buffer)
+    {
+      enqueued_buffer_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return buffer;
+  }
+
+  /*!
+   * \return Magazine of current thread for this pool - NULL if current thread has none (does not create any thread-local state)
+   */
+  tMagazine* FindMagazine()
+  {
+    std::vector<tMagazine*>& magazines = ThreadMagazines().magazines;
+    for (auto it = magazines.begin(); it != magazines.end(); ++it)
+    {
+      if ((*it)->owner.load(std::memory_order_relaxed) == this)
+      {
+        return *it;
+      }
+    }
+    return NULL;
+  }
+
+  /*!
+   * \return Magazine of current thread for this pool (created on first call)
+   */
+  tMagazine& GetMagazine()
+  {
+    tMagazine* existing = FindMagazine();
+    if (existing)
+    {
+      return *existing;
+    }
+
+    // Magazine does not exist yet: remove magazines of deleted pools and create new one
+    thread::tLock lock(RegistryMutex());
+    std::vector<tMagazine*>& magazines = ThreadMagazines().magazines;
+    for (auto it = magazines.begin(); it != magazines.end();)
+    {
+      if ((*it)->owner.load(std::memory_order_relaxed) == NULL)
+      {
+        delete *it;
+        it = magazines.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+    tMagazine* magazine = new tMagazine(this);
+    magazine->next_magazine = first_magazine;
+    first_magazine = magazine;
+    magazines.push_back(magazine);
+    return *magazine;
+  }
+
+  /*!
+   * Takes buffers from magazines of all threads.
+   * Called if there are no buffers in magazine of current thread and in shared queue.
+   * Magazine of current thread must not be locked.
+   *
+   * \param count Maximum number of buffers to obtain
+   * \param function Function (T* buffer, const tBufferManagementInfo& info) to call for every buffer obtained
+   * \param info Buffer management info to pass to function
+   * \return Number of buffers obtained
+   */
+  template <typename TFunction>
+  size_t StealBuffers(size_t count, TFunction function, const tBufferManagementInfo& info)
+  {
+    size_t obtained = 0;
+    thread::tLock lock(RegistryMutex());
+    for (tMagazine* magazine = first_magazine; magazine && obtained < count; magazine = magazine->next_magazine)
+    {
+      magazine->Lock();
+      for (; magazine->count && obtained < count; obtained++)
+      {
+        function(magazine->buffers[--magazine->count], info);
+      }
+      magazine->Unlock();
+    }
+    return obtained;
+  }
+
+  /*!
+   * Removes magazine from linked list of magazines (RegistryMutex() must be locked)
+   */
+  void RemoveMagazine(tMagazine* magazine)
+  {
+    for (tMagazine** current = &first_magazine; *current; current = &((*current)->next_magazine))
+    {
+      if (*current == magazine)
+      {
+        *current = magazine->next_magazine;
+        return;
+      }
+    }
+  }
+
+  /*!
+   * \return Mutex for (rare) operations on linked lists of magazines
+   */
+  static thread::tMutex& RegistryMutex()
+  {
+    static thread::tMutex mutex;
+    return mutex;
+  }
+
+  static tThreadMagazines& ThreadMagazines()
+  {
+    static thread_local tThreadMagazines magazines;
+    return magazines;
+  }
+
+  static inline void NotifyOnRecycle(void*) {}
+  static inline void NotifyOnRecycle(tNotifyOnRecycle* recycled)
+  {
+    static_cast<T*>(recycled)->OnRecycle();
+  }
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+
+#endif
@@ -0,0 +1,401 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/policies/management/StackBased.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains StackBased
+ *
+ * \b StackBased
+ *
+ * Buffer management based on a lock-free stack (LIFO) of unused buffers
+ * that is linked via the buffers' tBufferManagementInfo.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__policies__management__StackBased_h__
+#define __rrlib__buffer_pools__policies__management__StackBased_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/concurrent_containers/tConcurrency.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tBufferManagementInfo.h"
+#include "rrlib/buffer_pools/tClaimConflictCounter.h"
+#include "rrlib/buffer_pools/tNotifyOnRecycle.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+namespace management
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Stack-based buffer management
+/*!
+ * Buffer management based on a lock-free stack (Treiber stack) of unused buffers.
+ * While a buffer is unused, its tBufferManagementInfo stores the pointer to the next unused buffer.
+ * The stack's head contains a tag that is incremented with every pop operation (so that it is ABA-safe).
+ *
+ * Pro: The most recently recycled buffer - which is likely still in cache - is reused first.
+ *      No memory overhead: types T need not be queueable.
+ * Con: Types T must be derived from tBufferManagementInfo (UseBufferContainer recycling policy is an alternative).
+ *      With multiple readers, RemoveUnusedBuffers() must not be called while other threads obtain buffers
+ *      (they might still read the link of a buffer that is being deleted).
+ */
+template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename TBufferDeleter>
+class StackBased
+{
+  static_assert(sizeof(void*) == 4 || sizeof(void*) == 8, "Unsupported pointer size");
+
+  enum { cMULTIPLE_READERS = (CONCURRENCY == concurrent_containers::tConcurrency::FULL) || (CONCURRENCY == concurrent_containers::tConcurrency::MULTIPLE_READERS) };
+
+  /*! Head of stack: top buffer in lower bits and tag in upper bits (user-space addresses on 64 bit platforms have 48 bits) */
+  typedef uint64_t tHead;
+  enum { cTAG_SHIFT = sizeof(void*) == 4 ? 32 : 48 };
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  StackBased() :
+    head(0),
+    buffer_count(0),
+    unused_buffer_count(0)
+  {}
+
+  /*!
+   * Transfers a buffer in use from another pool of the same type to this pool
+   * (buffer is recycled into this pool from now on)
+   *
+   * \param buffer Buffer to transfer
+   * \param info Buffer management info of buffer (refers to previous owner). Is updated to refer to this pool.
+   */
+  void AdoptBuffer(T* buffer, tBufferManagementInfo& info)
+  {
+    StackBased* previous_owner = static_cast<StackBased*>(info.buffer_management_info);
+    if (previous_owner != this)
+    {
+      previous_owner->buffer_count--;
+      buffer_count++;
+      info.buffer_management_info = this;
+    }
+  }
+
+  void AddBuffer(T* buffer, tBufferManagementInfo& info)
+  {
+    static_assert(std::is_base_of<tBufferManagementInfo, T>::value, "Type T must be subclass of tBufferManagementInfo for this policy. Choosing UseBufferContainer Recycling policy might be an alternative.");
+    buffer_count++;
+    info.buffer_management_info = this;
+  }
+
+  /*!
+   * Prepares management structures for the specified number of additional buffers
+   *
+   * \param additional_buffers Number of buffers that are about to be added
+   */
+  void Reserve(size_t additional_buffers)
+  {
+    // stack does not need any preparation
+  }
+
+  /*!
+   * \return Number of buffers that have not been returned yet
+   */
+  int DeleteGarbage()
+  {
+    while (T* buffer = Pop())
+    {
+      TBufferDeleter deleter;
+      deleter(buffer);
+      buffer_count--;
+    }
+    return buffer_count;
+  }
+
+  /*!
+   * \return Number of buffers in this pool (including buffers in use)
+   */
+  size_t GetBufferCount()
+  {
+    return buffer_count.load();
+  }
+
+  /*!
+   * Determines number of unused buffers without obtaining them (e.g. for trimming idle buffers).
+   * Buffers may be obtained and recycled concurrently - so the result is a snapshot only.
+   *
+   * \return Number of unused buffers in this pool
+   */
+  size_t GetUnusedBufferCount()
+  {
+    return std::max(unused_buffer_count.load(std::memory_order_relaxed), 0);
+  }
+
+  T* GetUnusedBuffer(tBufferManagementInfo& info)
+  {
+    info.buffer_management_info = this;
+    return Pop();
+  }
+
+  /*!
+   * Obtains up to count unused buffers in one operation
+   *
+   * \param count Maximum number of buffers to obtain
+   * \param function Function (T* buffer, const tBufferManagementInfo& info) to call for every buffer obtained
+   * \return Number of buffers obtained
+   */
+  template <typename TFunction>
+  size_t GetUnusedBuffers(size_t count, TFunction function)
+  {
+    tBufferManagementInfo info;
+    info.buffer_management_info = this;
+    size_t obtained = 0;
+    if (!cMULTIPLE_READERS && count)
+    {
+      // only this thread pops buffers: links below head do not change and a chain of buffers can be obtained in one operation
+      tHead current = head.load(std::memory_order_acquire);
+      T* first = NULL;
+      T* last = NULL;
+      do
+      {
+        first = GetBuffer(current);
+        if (!first)
+        {
+          return 0;
+        }
+        last = first;
+        obtained = 1;
+        for (T* next = GetNext(*last); obtained < count && next; next = GetNext(*last))
+        {
+          last = next;
+          obtained++;
+        }
+      }
+      while (!head.compare_exchange_weak(current, Combine(GetNext(*last), GetTag(current) + 1), std::memory_order_acquire, std::memory_order_acquire)); // retry if buffers were pushed meanwhile
+      unused_buffer_count.fetch_sub(static_cast<int>(obtained), std::memory_order_relaxed);
+      for (T* buffer = first, *end = GetNext(*last); buffer != end;)
+      {
+        T* next = GetNext(*buffer);
+        Link(*buffer).store(this, std::memory_order_relaxed);
+        function(buffer, info);
+        buffer = next;
+      }
+      return obtained;
+    }
+
+    for (; obtained < count; obtained++)
+    {
+      T* buffer = Pop();
+      if (!buffer)
+      {
+        break;
+      }
+      function(buffer, info);
+    }
+    return obtained;
+  }
+
+  /*!
+   * \param info Buffer management info of a buffer (obtained from a pool with this policy)
+   * \return Buffer management object of pool that buffer belongs to
+   */
+  static StackBased* GetOwner(const tBufferManagementInfo& info)
+  {
+    return static_cast<StackBased*>(info.buffer_management_info);
+  }
+
+  /*!
+   * Removes up to count unused buffers from this pool and deletes them
+   *
+   * \param count Maximum number of buffers to remove
+   * \return Number of buffers removed
+   */
+  size_t RemoveUnusedBuffers(size_t count)
+  {
+    size_t removed = GetUnusedBuffers(count, [](T * buffer, const tBufferManagementInfo&)
+    {
+      TBufferDeleter deleter;
+      deleter(buffer);
+    });
+    buffer_count -= removed;
+    return removed;
+  }
+
+  static void RecycleBuffer(const tBufferManagementInfo& info, T* buffer)
+  {
+    assert(info.buffer_management_info && "Received empty buffer_management_info. This is not allowed using this policy.");
+    StackBased* owner_pool = static_cast<StackBased*>(info.buffer_management_info);
+    NotifyOnRecycle(buffer);
+    owner_pool->Push(buffer, buffer, 1);
+  }
+
+  /*!
+   * Recycles multiple buffers in one operation
+   * (buffers may originate from different pools)
+   *
+   * \param buffers Buffers to recycle together with their buffer management info
+   * \param count Number of buffers
+   */
+  static void RecycleBuffers(const std::pair<tBufferManagementInfo, T*>* buffers, size_t count)
+  {
+    // consecutive buffers from the same pool are linked and pushed with a single operation
+    for (size_t i = 0; i < count;)
+    {
+      StackBased* owner_pool = static_cast<StackBased*>(buffers[i].first.buffer_management_info);
+      assert(owner_pool && "Received empty buffer_management_info. This is not allowed using this policy.");
+      T* first = buffers[i].second;
+      T* last = first;
+      size_t first_index = i;
+      NotifyOnRecycle(first);
+      for (i++; i < count && buffers[i].first.buffer_management_info == owner_pool; i++)
+      {
+        NotifyOnRecycle(buffers[i].second);
+        Link(*last).store(buffers[i].second, std::memory_order_relaxed);
+        last = buffers[i].second;
+      }
+      owner_pool->Push(first, last, i - first_index);
+    }
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Head of stack with unused buffers of this pool */
+  std::atomic<tHead> head;
+
+  /*! Number of buffers in this pool */
+  std::atomic<int> buffer_count;
+
+  /*! Number of buffers on stack (incremented before pushing and decremented after popping - so that it is never negative) */
+  std::atomic<int> unused_buffer_count;
+
+
+  static tHead Combine(T* buffer, tHead tag)
+  {
+    tHead address = reinterpret_cast<uintptr_t>(buffer);
+    assert((address >> cTAG_SHIFT) == 0 && "Buffer address does not fit into head of stack");
+    return address | (tag << cTAG_SHIFT);
+  }
+
+  static T* GetBuffer(tHead head)
+  {
+    return reinterpret_cast<T*>(static_cast<uintptr_t>(head & ((static_cast<tHead>(1) << cTAG_SHIFT) - 1)));
+  }
+
+  static T* GetNext(T& buffer)
+  {
+    return static_cast<T*>(Link(buffer).load(std::memory_order_relaxed));
+  }
+
+  static tHead GetTag(tHead head)
+  {
+    return head >> cTAG_SHIFT;
+  }
+
+  /*!
+   * \return Buffer's management info storage - accessed atomically, as threads that obtain buffers concurrently may read it
+   */
+  static std::atomic<void*>& Link(T& buffer)
+  {
+    static_assert(sizeof(std::atomic<void*>) == sizeof(void*), "Atomic pointer must not have any overhead");
+    return reinterpret_cast<std::atomic<void*>&>(static_cast<tBufferManagementInfo&>(buffer).buffer_management_info);
+  }
+
+  static inline void NotifyOnRecycle(void*) {}
+  static inline void NotifyOnRecycle(tNotifyOnRecycle* recycled)
+  {
+    static_cast<T*>(recycled)->OnRecycle();
+  }
+
+  /*!
+   * \return Top buffer from stack (NULL if stack is empty)
+   */
+  T* Pop()
+  {
+    tHead current = head.load(std::memory_order_acquire);
+    while (T* top = GetBuffer(current))
+    {
+      T* next = GetNext(*top);
+      if (head.compare_exchange_weak(current, Combine(next, GetTag(current) + 1), std::memory_order_acquire, std::memory_order_acquire))
+      {
+        Link(*top).store(this, std::memory_order_relaxed); // management info refers to owner pool again (UseOwnerStorageInBuffer relies on this)
+        unused_buffer_count.fetch_sub(1, std::memory_order_relaxed);
+        return top;
+      }
+      tClaimConflictCounter::Increment();
+    }
+    return NULL;
+  }
+
+  /*!
+   * Pushes a chain of linked buffers on stack
+   *
+   * \param first First buffer of chain
+   * \param last Last buffer of chain
+   * \param count Number of buffers in chain
+   */
+  void Push(T* first, T* last, size_t count)
+  {
+    unused_buffer_count.fetch_add(static_cast<int>(count), std::memory_order_relaxed); // pool might be deleted after push
+    tHead current = head.load(std::memory_order_relaxed);
+    do
+    {
+      Link(*last).store(GetBuffer(current), std::memory_order_relaxed);
+    }
+    while (!head.compare_exchange_weak(current, Combine(first, GetTag(current)), std::memory_order_release, std::memory_order_relaxed));
+  }
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+
+#endif
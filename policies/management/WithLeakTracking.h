@@ -0,0 +1,358 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/policies/management/WithLeakTracking.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains WithLeakTracking
+ *
+ * \b WithLeakTracking
+ *
+ * Adds tracking of outstanding buffers to a buffer management policy.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__policies__management__WithLeakTracking_h__
+#define __rrlib__buffer_pools__policies__management__WithLeakTracking_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/concurrent_containers/tConcurrency.h"
+#include "rrlib/logging/messages.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <execinfo.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <utility>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tBufferManagementInfo.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+namespace management
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Buffer management with tracking of outstanding buffers
+/*!
+ * Buffer management policy that passes all operations to another management policy
+ * and records the acquiring thread, a timestamp and optionally a short backtrace for every buffer in use.
+ * Typically, this class is not used directly but via WithLeakTracking.
+ *
+ * Records are stored in a lock-free table shared by all pools of this type:
+ * A buffer's record is placed in one of cMAX_PROBES slots following the slot its address hashes to.
+ * If all of them are occupied, the buffer is not tracked (and counted as untracked).
+ *
+ * T                  Type of buffers
+ * TBufferManagement  Buffer management policy (instantiated) to pass operations to
+ * BACKTRACE_DEPTH    Number of stack frames to record (0 for no backtraces; recording backtraces is expensive)
+ * TRACKING_SLOTS     Size of record table (power of two)
+ */
+template <typename T, typename TBufferManagement, size_t BACKTRACE_DEPTH, size_t TRACKING_SLOTS>
+class LeakTrackingManagement : public TBufferManagement
+{
+  static_assert(TRACKING_SLOTS > 0 && (TRACKING_SLOTS & (TRACKING_SLOTS - 1)) == 0, "TRACKING_SLOTS must be a power of two");
+
+  enum { cMAX_PROBES = TRACKING_SLOTS < 64 ? TRACKING_SLOTS : 64 };
+
+  /*! Record of an outstanding buffer */
+  struct tRecord
+  {
+    /*! Buffer that this record belongs to - NULL if slot is free */
+    std::atomic<const void*> buffer;
+
+    /*! Management object of buffer's pool. Set when record is complete. */
+    std::atomic<const void*> owner;
+
+    /*! Id of thread that obtained buffer */
+    std::atomic<long> thread_id;
+
+    /*! Time when buffer was obtained (nanoseconds since steady clock's epoch) */
+    std::atomic<int64_t> timestamp;
+
+    /*! Backtrace of thread when it obtained buffer */
+    std::array<std::atomic<void*>, BACKTRACE_DEPTH> backtrace;
+
+    /*! Number of valid entries in backtrace */
+    std::atomic<int> backtrace_size;
+
+    tRecord() : buffer(NULL), owner(NULL), thread_id(0), timestamp(0), backtrace(), backtrace_size(0) {}
+  };
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  ~LeakTrackingManagement()
+  {
+    // forget buffers that were not returned (a new pool might be allocated at the same address)
+    for (tRecord & record : Records())
+    {
+      if (record.owner.load(std::memory_order_acquire) == this)
+      {
+        record.owner.store(NULL, std::memory_order_relaxed);
+        record.buffer.store(NULL, std::memory_order_release);
+      }
+    }
+  }
+
+  void AddBuffer(T* buffer, tBufferManagementInfo& info)
+  {
+    TBufferManagement::AddBuffer(buffer, info);
+    Track(buffer);
+  }
+
+  /*!
+   * Prints records of buffers of this pool that are currently in use
+   *
+   * \param minimum_age Only buffers that have been in use for at least this duration are printed
+   * \return Number of buffers printed
+   */
+  size_t DumpOutstandingBuffers(std::chrono::nanoseconds minimum_age = std::chrono::nanoseconds::zero()) const
+  {
+    size_t printed = 0;
+    int64_t now = Now();
+    for (tRecord & record : Records())
+    {
+      const void* buffer = record.buffer.load(std::memory_order_relaxed);
+      if (!buffer || record.owner.load(std::memory_order_acquire) != this)
+      {
+        continue;
+      }
+      int64_t age = now - record.timestamp.load(std::memory_order_relaxed);
+      if (age < minimum_age.count())
+      {
+        continue;
+      }
+      RRLIB_LOG_PRINT(WARNING, "Buffer ", buffer, " obtained by thread ", record.thread_id.load(std::memory_order_relaxed), " has been in use for ", age / 1000000, " ms");
+      int backtrace_size = record.backtrace_size.load(std::memory_order_relaxed);
+      if (backtrace_size > 0)
+      {
+        std::array < void*, BACKTRACE_DEPTH + 1 > frames;
+        for (int i = 0; i < backtrace_size; i++)
+        {
+          frames[i] = record.backtrace[i].load(std::memory_order_relaxed);
+        }
+        char** symbols = backtrace_symbols(frames.data(), backtrace_size);
+        for (int i = 0; symbols && i < backtrace_size; i++)
+        {
+          RRLIB_LOG_PRINT(WARNING, "  at ", symbols[i]);
+        }
+        free(symbols);
+      }
+      printed++;
+    }
+    size_t untracked = UntrackedBufferCount().load(std::memory_order_relaxed);
+    if (untracked)
+    {
+      RRLIB_LOG_PRINT(WARNING, untracked, " buffers of pools of this type could not be tracked (consider more tracking slots)");
+    }
+    return printed;
+  }
+
+  /*!
+   * \return Number of tracked buffers of this pool that are currently in use
+   */
+  size_t GetOutstandingBufferCount() const
+  {
+    size_t count = 0;
+    for (tRecord & record : Records())
+    {
+      if (record.buffer.load(std::memory_order_relaxed) && record.owner.load(std::memory_order_acquire) == this)
+      {
+        count++;
+      }
+    }
+    return count;
+  }
+
+  T* GetUnusedBuffer(tBufferManagementInfo& info)
+  {
+    T* buffer = TBufferManagement::GetUnusedBuffer(info);
+    if (buffer)
+    {
+      Track(buffer);
+    }
+    return buffer;
+  }
+
+  template <typename TFunction>
+  size_t GetUnusedBuffers(size_t count, TFunction function)
+  {
+    return TBufferManagement::GetUnusedBuffers(count, [this, &function](T * buffer, const tBufferManagementInfo & info)
+    {
+      Track(buffer);
+      function(buffer, info);
+    });
+  }
+
+  static void RecycleBuffer(const tBufferManagementInfo& info, T* buffer)
+  {
+    Untrack(buffer); // before buffer is available again
+    TBufferManagement::RecycleBuffer(info, buffer);
+  }
+
+  static void RecycleBuffers(const std::pair<tBufferManagementInfo, T*>* buffers, size_t count)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      Untrack(buffers[i].second);
+    }
+    TBufferManagement::RecycleBuffers(buffers, count);
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  static size_t Hash(const void* buffer)
+  {
+    return ((reinterpret_cast<uintptr_t>(buffer) >> 4) * 0x9E3779B97F4A7C15ull) >> 32;
+  }
+
+  static int64_t Now()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  static std::array<tRecord, TRACKING_SLOTS>& Records()
+  {
+    static std::array<tRecord, TRACKING_SLOTS> records;
+    return records;
+  }
+
+  /*!
+   * \return Id of current thread (as shown by debuggers and top)
+   */
+  static long ThreadId()
+  {
+    static thread_local long thread_id = syscall(SYS_gettid);
+    return thread_id;
+  }
+
+  void Track(const void* buffer)
+  {
+    std::array<tRecord, TRACKING_SLOTS>& records = Records();
+    size_t start = Hash(buffer);
+    for (size_t i = 0; i < cMAX_PROBES; i++)
+    {
+      tRecord& record = records[(start + i) & (TRACKING_SLOTS - 1)];
+      const void* expected = NULL;
+      if (record.buffer.load(std::memory_order_relaxed) == NULL && record.buffer.compare_exchange_strong(expected, buffer, std::memory_order_acquire))
+      {
+        record.thread_id.store(ThreadId(), std::memory_order_relaxed);
+        record.timestamp.store(Now(), std::memory_order_relaxed);
+        if (BACKTRACE_DEPTH)
+        {
+          std::array < void*, BACKTRACE_DEPTH + 2 > frames;
+          int size = backtrace(frames.data(), frames.size());
+          size = size > 2 ? size - 2 : 0; // skip frames of buffer pool
+          for (int j = 0; j < size; j++)
+          {
+            record.backtrace[j].store(frames[j + 2], std::memory_order_relaxed);
+          }
+          record.backtrace_size.store(size, std::memory_order_relaxed);
+        }
+        record.owner.store(this, std::memory_order_release);
+        return;
+      }
+    }
+    UntrackedBufferCount().fetch_add(1, std::memory_order_relaxed);
+  }
+
+  static void Untrack(const void* buffer)
+  {
+    std::array<tRecord, TRACKING_SLOTS>& records = Records();
+    size_t start = Hash(buffer);
+    for (size_t i = 0; i < cMAX_PROBES; i++)
+    {
+      tRecord& record = records[(start + i) & (TRACKING_SLOTS - 1)];
+      if (record.buffer.load(std::memory_order_relaxed) == buffer)
+      {
+        record.owner.store(NULL, std::memory_order_relaxed);
+        record.buffer.store(NULL, std::memory_order_release);
+        return;
+      }
+    }
+  }
+
+  static std::atomic<size_t>& UntrackedBufferCount()
+  {
+    static std::atomic<size_t> count(0);
+    return count;
+  }
+};
+
+/*!
+ * Adds tracking of outstanding buffers to buffer management policy.
+ * Use WithLeakTracking<...>::tPolicy as buffer management policy of tBufferPool - e.g.
+ *
+ *   tBufferPool<T, CONCURRENCY, management::WithLeakTracking<management::ArrayAndFlagBased, 8>::tPolicy>
+ *
+ * deleting::ComplainOnMissingBuffers prints the records of all missing buffers then.
+ * Buffers held longer than a threshold can be printed on demand via tBufferPool::DumpOutstandingBuffers().
+ *
+ * TBufferManagementPolicy  Buffer management policy
+ * BACKTRACE_DEPTH          Number of stack frames to record (0 for no backtraces)
+ * TRACKING_SLOTS           Size of record table (power of two) - should be considerably larger than number of buffers in use
+ */
+template < template <typename, concurrent_containers::tConcurrency, typename ...> class TBufferManagementPolicy,
+         size_t BACKTRACE_DEPTH = 0,
+         size_t TRACKING_SLOTS = 4096 >
+struct WithLeakTracking
+{
+  template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename ... TArgs>
+  using tPolicy = LeakTrackingManagement<T, TBufferManagementPolicy<T, CONCURRENCY, TArgs...>, BACKTRACE_DEPTH, TRACKING_SLOTS>;
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+
+#endif
@@ -0,0 +1,216 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/policies/management/WithStatistics.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains WithStatistics
+ *
+ * \b WithStatistics
+ *
+ * Adds a statistics policy to a buffer management policy.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__policies__management__WithStatistics_h__
+#define __rrlib__buffer_pools__policies__management__WithStatistics_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/concurrent_containers/tConcurrency.h"
+#include <type_traits>
+#include <utility>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tBufferManagementInfo.h"
+#include "rrlib/buffer_pools/tClaimConflictCounter.h"
+#include "rrlib/buffer_pools/tStatisticsSnapshot.h"
+#include "rrlib/buffer_pools/policies/statistics/None.h"
+#include "rrlib/buffer_pools/policies/statistics/ShardedCounters.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+namespace management
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Buffer management with statistics
+/*!
+ * Buffer management policy that passes all operations to another management
+ * policy and reports them to a statistics policy.
+ * Typically, this class is not used directly but via WithStatistics.
+ *
+ * Statistics are collected per pool. Therefore, the management policy must be able to determine
+ * the owner pool of a recycled buffer (GetOwner() - provided by all management policies in this library).
+ *
+ * T                  Type of buffers
+ * TBufferManagement  Buffer management policy (instantiated) to pass operations to
+ * TStatistics        Statistics policy (e.g. statistics::ShardedCounters)
+ */
+template <typename T, typename TBufferManagement, typename TStatistics>
+class StatisticsCollectingManagement : public TBufferManagement
+{
+  /*! Type trait: Does TBufferManagement provide GetOwner()? */
+  template <typename U>
+  static std::true_type HasGetOwner(decltype(U::GetOwner(std::declval<const tBufferManagementInfo&>()))*);
+  template <typename U>
+  static std::false_type HasGetOwner(...);
+
+  static_assert(decltype(HasGetOwner<TBufferManagement>(nullptr))::value, "Buffer management policy must provide GetOwner() to collect statistics per pool");
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  StatisticsCollectingManagement() :
+    statistics()
+  {}
+
+  void AddBuffer(T* buffer, tBufferManagementInfo& info)
+  {
+    TBufferManagement::AddBuffer(buffer, info);
+    statistics.OnAdd();
+  }
+
+  /*!
+   * \return Snapshot of statistics of this pool
+   */
+  tStatisticsSnapshot GetStatistics()
+  {
+    return statistics.GetSnapshot();
+  }
+
+  T* GetUnusedBuffer(tBufferManagementInfo& info)
+  {
+    size_t claim_conflicts = tClaimConflictCounter::Get();
+    T* buffer = TBufferManagement::GetUnusedBuffer(info);
+    statistics.OnClaimConflicts(tClaimConflictCounter::Get() - claim_conflicts);
+    if (buffer)
+    {
+      statistics.OnAcquire(buffer);
+    }
+    else
+    {
+      statistics.OnMiss();
+    }
+    return buffer;
+  }
+
+  template <typename TFunction>
+  size_t GetUnusedBuffers(size_t count, TFunction function)
+  {
+    size_t claim_conflicts = tClaimConflictCounter::Get();
+    size_t obtained = TBufferManagement::GetUnusedBuffers(count, [this, &function](T * buffer, const tBufferManagementInfo & info)
+    {
+      this->statistics.OnAcquire(buffer);
+      function(buffer, info);
+    });
+    statistics.OnClaimConflicts(tClaimConflictCounter::Get() - claim_conflicts);
+    if (obtained < count)
+    {
+      statistics.OnMiss();
+    }
+    return obtained;
+  }
+
+  static void RecycleBuffer(const tBufferManagementInfo& info, T* buffer)
+  {
+    GetOwnerStatistics(info).OnRecycle(buffer);
+    TBufferManagement::RecycleBuffer(info, buffer);
+  }
+
+  static void RecycleBuffers(const std::pair<tBufferManagementInfo, T*>* buffers, size_t count)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      GetOwnerStatistics(buffers[i].first).OnRecycle(buffers[i].second);
+    }
+    TBufferManagement::RecycleBuffers(buffers, count);
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Statistics of this pool */
+  TStatistics statistics;
+
+
+  /*!
+   * \param info Buffer management info of a buffer
+   * \return Statistics of pool that buffer belongs to
+   */
+  static TStatistics& GetOwnerStatistics(const tBufferManagementInfo& info)
+  {
+    return static_cast<StatisticsCollectingManagement*>(TBufferManagement::GetOwner(info))->statistics;
+  }
+};
+
+/*!
+ * Adds statistics policy to buffer management policy.
+ * Use WithStatistics<...>::tPolicy as buffer management policy of tBufferPool - e.g.
+ *
+ *   tBufferPool<T, CONCURRENCY, management::WithStatistics<management::ArrayAndFlagBased>::tPolicy>
+ *
+ * Statistics can then be obtained via tBufferPool::GetStatistics().
+ * With statistics::None, tPolicy is the plain management policy (no overhead at all).
+ *
+ * TBufferManagementPolicy  Buffer management policy
+ * TStatistics              Statistics policy (e.g. statistics::ShardedCounters or statistics::None)
+ */
+template < template <typename, concurrent_containers::tConcurrency, typename ...> class TBufferManagementPolicy,
+         typename TStatistics = statistics::ShardedCounters<> >
+struct WithStatistics
+{
+  template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename ... TArgs>
+  using tPolicy = typename std::conditional < std::is_same<TStatistics, statistics::None>::value,
+        TBufferManagementPolicy<T, CONCURRENCY, TArgs...>,
+        StatisticsCollectingManagement<T, TBufferManagementPolicy<T, CONCURRENCY, TArgs...>, TStatistics >>::type;
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+
+#endif
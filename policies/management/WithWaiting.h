@@ -0,0 +1,221 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/policies/management/WithWaiting.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains WithWaiting
+ *
+ * \b WithWaiting
+ *
+ * Lets threads wait for buffers to be recycled to pools with a buffer management policy.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__policies__management__WithWaiting_h__
+#define __rrlib__buffer_pools__policies__management__WithWaiting_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/concurrent_containers/tConcurrency.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tBufferManagementInfo.h"
+#include "rrlib/buffer_pools/tEventCount.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+namespace management
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Buffer management that threads can wait on
+/*!
+ * Buffer management policy that passes all operations to another management policy
+ * and notifies threads waiting in tBufferPool::GetUnusedBuffer(timeout) when buffers are recycled.
+ * Typically, this class is not used directly but via WithWaiting.
+ *
+ * If the management policy can determine the owner pool of a recycled buffer (it has a GetOwner() method
+ * - e.g. QueueBased, StackBased or BitmapBased), pools are distributed among a table of event counts.
+ * Otherwise, all pools of this type share one event count.
+ * Waiting threads may wake up spuriously when buffers of other pools are recycled.
+ *
+ * Event counts are not members of the management object: once a buffer has been recycled,
+ * its pool may be deleted by another thread - before the recycling thread has notified waiting threads.
+ * Event counts in static storage remain valid.
+ *
+ * T                  Type of buffers
+ * TBufferManagement  Buffer management policy (instantiated) to pass operations to
+ */
+template <typename T, typename TBufferManagement>
+class WaitingManagement : public TBufferManagement
+{
+  /*! Type trait: Does TBufferManagement provide GetOwner()? */
+  template <typename U>
+  static std::true_type HasGetOwner(decltype(U::GetOwner(std::declval<const tBufferManagementInfo&>()))*);
+  template <typename U>
+  static std::false_type HasGetOwner(...);
+
+  enum { cEVENT_PER_POOL = decltype(HasGetOwner<TBufferManagement>(nullptr))::value };
+
+  /*! Number of event counts in table (see EventTable()) */
+  enum { cEVENT_TABLE_SIZE = 64 };
+  static_assert(cEVENT_TABLE_SIZE == (1 << 6), "GetEvent() uses upper 6 bits of hash");
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*!
+   * \return Event count that threads waiting for recycled buffers park on
+   */
+  tEventCount& RecycleEvent()
+  {
+    return GetPoolRecycleEvent();
+  }
+
+  static void RecycleBuffer(const tBufferManagementInfo& info, T* buffer)
+  {
+    tEventCount& event = GetRecycleEvent(info); // info may be modified - and pool deleted - when buffer is recycled
+    TBufferManagement::RecycleBuffer(info, buffer);
+    std::atomic_thread_fence(std::memory_order_seq_cst); // order publishing buffer before checking for waiting threads
+    event.Notify();
+  }
+
+  static void RecycleBuffers(const std::pair<tBufferManagementInfo, T*>* buffers, size_t count)
+  {
+    // waiting threads are notified once per run of buffers from the same pool
+    for (size_t i = 0; i < count;)
+    {
+      tEventCount& event = GetRecycleEvent(buffers[i].first);
+      size_t end = i + 1;
+      while (end < count && &GetRecycleEvent(buffers[end].first) == &event)
+      {
+        end++;
+      }
+      TBufferManagement::RecycleBuffers(&buffers[i], end - i);
+      std::atomic_thread_fence(std::memory_order_seq_cst); // order publishing buffers before checking for waiting threads
+      event.Notify();
+      i = end;
+    }
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  template <bool EVENT_PER_POOL = cEVENT_PER_POOL>
+  static tEventCount& GetRecycleEvent(const typename std::enable_if<EVENT_PER_POOL, tBufferManagementInfo>::type& info)
+  {
+    return GetEvent(TBufferManagement::GetOwner(info));
+  }
+
+  template <bool EVENT_PER_POOL = cEVENT_PER_POOL>
+  static tEventCount& GetRecycleEvent(const typename std::enable_if < !EVENT_PER_POOL, tBufferManagementInfo >::type& info)
+  {
+    return EventTable()[0];
+  }
+
+  template <bool EVENT_PER_POOL = cEVENT_PER_POOL>
+  typename std::enable_if<EVENT_PER_POOL, tEventCount&>::type GetPoolRecycleEvent()
+  {
+    typedef decltype(TBufferManagement::GetOwner(std::declval<const tBufferManagementInfo&>())) tOwnerPointer;
+    return GetEvent(static_cast<tOwnerPointer>(this)); // same pointer as GetOwner() returns for buffers of this pool
+  }
+
+  template <bool EVENT_PER_POOL = cEVENT_PER_POOL>
+  typename std::enable_if < !EVENT_PER_POOL, tEventCount& >::type GetPoolRecycleEvent()
+  {
+    return EventTable()[0];
+  }
+
+  /*!
+   * \param owner Management object of pool (as returned by GetOwner())
+   * \return Event count of pool
+   */
+  static tEventCount& GetEvent(const void* owner)
+  {
+    uint64_t hash = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(owner)) * 0x9E3779B97F4A7C15ull; // Fibonacci hashing
+    return EventTable()[hash >> 58];
+  }
+
+  /*!
+   * \return Event counts of pools of this type (never deleted)
+   */
+  static std::array<tEventCount, cEVENT_TABLE_SIZE>& EventTable()
+  {
+    static std::array<tEventCount, cEVENT_TABLE_SIZE> events;
+    return events;
+  }
+};
+
+/*!
+ * Lets threads wait for recycled buffers - via tBufferPool::GetUnusedBuffer(timeout) and tBufferPool::GetUnusedBufferUntil(deadline).
+ * Use WithWaiting<...>::tPolicy as buffer management policy of tBufferPool - e.g.
+ *
+ *   tBufferPool<T, CONCURRENCY, management::WithWaiting<management::QueueBased>::tPolicy>
+ *
+ * Recycling buffers costs an additional full memory barrier then (plus a load if no thread is waiting).
+ * Pools with plain management policies do not pay for this.
+ * QueueBasedWithThreadLocalCache is not supported: recycled buffers are kept in the recycling thread's magazine.
+ *
+ * TBufferManagementPolicy  Buffer management policy
+ */
+template <template <typename, concurrent_containers::tConcurrency, typename ...> class TBufferManagementPolicy>
+struct WithWaiting
+{
+  template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename ... TArgs>
+  using tPolicy = WaitingManagement<T, TBufferManagementPolicy<T, CONCURRENCY, TArgs...>>;
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+
+#endif
@@ -112,6 +112,29 @@ public:
     return tPointer(unused_buffer, StoreOwnerInUniquePointer(info));
   }
 
+  template <typename TIterator>
+  static size_t GetUnusedBuffers(TBufferManagementPolicy& buffer_management, TIterator output, size_t count)
+  {
+    return buffer_management.GetUnusedBuffers(count, [&output](T* buffer, const tBufferManagementInfo& info)
+    {
+      *output = tPointer(buffer, StoreOwnerInUniquePointer(info));
+      ++output;
+    });
+  }
+
+  /*!
+   * Releases buffer from pointer without recycling it
+   * (for recycling it later, e.g. in a batch via TBufferManagementPolicy::RecycleBuffers)
+   *
+   * \param pointer Pointer to release buffer from (non-null). Is null after call.
+   * \return Buffer management info and buffer
+   */
+  static std::pair<tBufferManagementInfo, tManagedType*> ReleaseBuffer(tPointer& pointer)
+  {
+    tBufferManagementInfo info = pointer.get_deleter().buffer_management_info;
+    return std::pair<tBufferManagementInfo, tManagedType*>(info, pointer.release());
+  }
+
 //----------------------------------------------------------------------
 // Private fields and methods
 //----------------------------------------------------------------------
@@ -104,6 +104,29 @@ public:
     return tPointer(buffer ? & (buffer->GetData()) : NULL);
   }
 
+  template <typename TIterator>
+  static size_t GetUnusedBuffers(TBufferManagementPolicy& buffer_management, TIterator output, size_t count)
+  {
+    return buffer_management.GetUnusedBuffers(count, [&output](tManagedType* buffer, const tBufferManagementInfo&)
+    {
+      *output = tPointer(&(buffer->GetData()));
+      ++output;
+    });
+  }
+
+  /*!
+   * Releases buffer from pointer without recycling it
+   * (for recycling it later, e.g. in a batch via TBufferManagementPolicy::RecycleBuffers)
+   *
+   * \param pointer Pointer to release buffer from (non-null). Is null after call.
+   * \return Buffer management info and buffer
+   */
+  static std::pair<tBufferManagementInfo, tManagedType*> ReleaseBuffer(tPointer& pointer)
+  {
+    tBufferContainer<T>* buffer = reinterpret_cast<tBufferContainer<T>*>(((char*)pointer.release()) - tBufferContainer<T>::GetBufferOffset());
+    return std::pair<tBufferManagementInfo, tManagedType*>(*buffer, buffer);
+  }
+
 //----------------------------------------------------------------------
 // Private fields and methods
 //----------------------------------------------------------------------
@@ -0,0 +1,439 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/policies/recycling/UseCompactHandles.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains UseCompactHandles
+ *
+ * \b UseCompactHandles
+ *
+ * Like UseOwnerStorageInBuffer - additionally, buffers in use can be converted
+ * to compact 32 bit handles (tBufferHandle) and back.
+ * Stale handles are detected via a generation counter.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__policies__recycling__UseCompactHandles_h__
+#define __rrlib__buffer_pools__policies__recycling__UseCompactHandles_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tBufferManagementInfo.h"
+#include "rrlib/buffer_pools/tHandleBuffer.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+namespace recycling
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Buffer management with handle table
+/*!
+ * Buffer management policy that passes all operations to another management policy
+ * and additionally maintains a table that maps slot indices to buffers.
+ * Every instance registers itself under a pool id (as long as it exists),
+ * so that handles can be resolved with two array lookups.
+ * This class is used by tBufferPool with the UseCompactHandles recycling policy.
+ *
+ * Slot indices are assigned in AddBuffer() and are not reused when buffers are removed from the pool.
+ * Each slot has a state: the current generation of the buffer and whether a handle to it is outstanding.
+ * When a pool is deleted, its pool id may be reused by a new pool. The new pool's slots continue with the generation
+ * after the highest one used by the deleted pool - so that stale handles to buffers of the deleted pool are detected.
+ *
+ * TBufferManagement  Buffer management policy (instantiated) to pass operations to
+ */
+template <typename TBufferManagement>
+class HandleTableManagement : public TBufferManagement
+{
+  enum { cSLOT_CHUNK_SIZE = 256 };
+  enum { cMAX_SLOT_CHUNKS = (tBufferHandle::cMAX_INDEX + 1) / cSLOT_CHUNK_SIZE };
+
+  typedef std::array < std::atomic<HandleTableManagement*>, tBufferHandle::cMAX_POOL_ID + 1 > tRegistry;
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! Entry in handle table */
+  struct tSlot
+  {
+    /*! Generation of buffer (shifted left by one) - lowest bit is set while a handle is outstanding */
+    std::atomic<uint32_t> state;
+
+    /*! Buffer in this slot */
+    tHandleBuffer* buffer;
+  };
+
+  HandleTableManagement() : pool_id(Register(this)), first_generation(FirstGenerations()[pool_id]), slot_count(0), slot_chunks()
+  {}
+
+  ~HandleTableManagement()
+  {
+    // Pool with same id continues after highest generation of this pool (so that handles to buffers of this pool are stale)
+    uint32_t max_distance = 0;
+    for (uint32_t i = 0; i < slot_count.load(std::memory_order_relaxed) && i <= tBufferHandle::cMAX_INDEX; i++)
+    {
+      uint32_t generation = slot_chunks[i / cSLOT_CHUNK_SIZE].load(std::memory_order_relaxed)[i % cSLOT_CHUNK_SIZE].state.load(std::memory_order_relaxed) >> 1;
+      max_distance = std::max(max_distance, (generation + tBufferHandle::cMAX_GENERATION - first_generation) % tBufferHandle::cMAX_GENERATION);
+    }
+    FirstGenerations()[pool_id] = slot_count.load(std::memory_order_relaxed) ? AdvanceGeneration(first_generation, max_distance + 1) : first_generation;
+    Registry()[pool_id].store(NULL, std::memory_order_release);
+    for (auto it = slot_chunks.begin(); it != slot_chunks.end(); ++it)
+    {
+      delete[] it->load(std::memory_order_relaxed);
+    }
+  }
+
+  template <typename T>
+  void AddBuffer(T* buffer, tBufferManagementInfo& info)
+  {
+    static_assert(std::is_base_of<tHandleBuffer, T>::value, "Type T must be subclass of tHandleBuffer for this policy.");
+    uint32_t index = slot_count.fetch_add(1, std::memory_order_relaxed);
+    if (index > tBufferHandle::cMAX_INDEX)
+    {
+      throw std::length_error("Maximum number of buffers in pool with compact handles exceeded");
+    }
+    tSlot& slot = GetOrCreateSlotChunk(index / cSLOT_CHUNK_SIZE)[index % cSLOT_CHUNK_SIZE];
+    slot.buffer = buffer;
+    slot.state.store(first_generation << 1, std::memory_order_release);
+    static_cast<tHandleBuffer&>(*buffer).handle_slot = tBufferHandle(pool_id, index, 0);
+    TBufferManagement::AddBuffer(buffer, info);
+  }
+
+  /*!
+   * \return Id of this pool in handles
+   */
+  uint32_t GetPoolId() const
+  {
+    return pool_id;
+  }
+
+  /*!
+   * \param handle Handle (generation is ignored)
+   * \return Slot that handle refers to - NULL if there is no such slot
+   */
+  static tSlot* GetSlot(tBufferHandle handle)
+  {
+    HandleTableManagement* pool = Registry()[handle.GetPoolId()].load(std::memory_order_acquire);
+    tSlot* chunk = pool ? pool->slot_chunks[handle.GetIndex() / cSLOT_CHUNK_SIZE].load(std::memory_order_acquire) : NULL;
+    return chunk ? &chunk[handle.GetIndex() % cSLOT_CHUNK_SIZE] : NULL;
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Id of this pool in handles */
+  const uint32_t pool_id;
+
+  /*! Generation of buffers when they are added to this pool */
+  const uint32_t first_generation;
+
+  /*! Number of slots that have been assigned to buffers */
+  std::atomic<uint32_t> slot_count;
+
+  /*! Handle table: Chunk i contains slots [i * cSLOT_CHUNK_SIZE, (i + 1) * cSLOT_CHUNK_SIZE) */
+  std::array<std::atomic<tSlot*>, cMAX_SLOT_CHUNKS> slot_chunks;
+
+
+  /*!
+   * \param generation Generation (1 to tBufferHandle::cMAX_GENERATION)
+   * \param steps Number of generations to advance
+   * \return Generation that follows specified number of steps after generation (wraps around after tBufferHandle::cMAX_GENERATION)
+   */
+  static uint32_t AdvanceGeneration(uint32_t generation, uint32_t steps)
+  {
+    return ((generation - 1 + steps) % tBufferHandle::cMAX_GENERATION) + 1;
+  }
+
+  /*!
+   * \return First generation of buffers in next pool with respective pool id
+   * (written by deleted pool before its pool id is released - and read by pool that obtains pool id)
+   */
+  static std::array < uint32_t, tBufferHandle::cMAX_POOL_ID + 1 > & FirstGenerations()
+  {
+    static std::array < uint32_t, tBufferHandle::cMAX_POOL_ID + 1 > first_generations = CreateFirstGenerations();
+    return first_generations;
+  }
+
+  static std::array < uint32_t, tBufferHandle::cMAX_POOL_ID + 1 > CreateFirstGenerations()
+  {
+    std::array < uint32_t, tBufferHandle::cMAX_POOL_ID + 1 > result;
+    result.fill(1);
+    return result;
+  }
+
+  /*!
+   * \return Slot chunk with specified index. Is allocated if it does not exist yet (lock-free).
+   */
+  tSlot* GetOrCreateSlotChunk(size_t chunk_index)
+  {
+    tSlot* chunk = slot_chunks[chunk_index].load(std::memory_order_acquire);
+    if (chunk)
+    {
+      return chunk;
+    }
+    tSlot* new_chunk = new tSlot[cSLOT_CHUNK_SIZE]();
+    if (slot_chunks[chunk_index].compare_exchange_strong(chunk, new_chunk))
+    {
+      return new_chunk;
+    }
+    delete[] new_chunk; // another thread was faster
+    return chunk;
+  }
+
+  /*!
+   * Registers pool under free pool id
+   *
+   * \param pool Pool to register
+   * \return Pool id
+   * \throw std::length_error if all pool ids are in use
+   */
+  static uint32_t Register(HandleTableManagement* pool)
+  {
+    tRegistry& registry = Registry();
+    for (uint32_t i = 0; i < registry.size(); i++)
+    {
+      HandleTableManagement* expected = NULL;
+      if (registry[i].load(std::memory_order_relaxed) == NULL && registry[i].compare_exchange_strong(expected, pool))
+      {
+        return i;
+      }
+    }
+    throw std::length_error("Maximum number of buffer pools with compact handles exceeded");
+  }
+
+  /*!
+   * \return Pools of this type by pool id
+   */
+  static tRegistry& Registry()
+  {
+    static tRegistry registry {};
+    return registry;
+  }
+};
+
+//! Recycling policy with compact buffer handles
+/*!
+ * Use owner storage in buffer (as UseOwnerStorageInBuffer). In order for this to work, the type T must be derived
+ * from tBufferManagementInfo and tHandleBuffer.
+ *
+ * In addition, buffers in use can be converted to compact 32 bit handles (ToHandle) and back (FromHandle).
+ * A handle contains pool id, slot index and generation (see tBufferHandle) - and takes over ownership of the buffer.
+ * Therefore, handles can be placed in packed message headers, lock-free 64 bit slots, or index-based data structures.
+ * Resolving a handle is an O(1) table lookup plus one compare-and-swap.
+ *
+ * Every handle can be resolved only once. The generation of a buffer is incremented whenever it is recycled.
+ * Handles that have already been resolved - or that refer to a buffer that has been recycled, removed or
+ * whose pool has been deleted - are stale: FromHandle() returns an empty pointer instead of a buffer in use elsewhere.
+ * As generations have 10 bits, a stale handle is detected reliably unless its buffer has been recycled a multiple of 1023 times.
+ * Handles to buffers of deleted pools are detected reliably until 1023 generations have been used in total
+ * by the buffers' slots in the deleted pool and in subsequent pools with the same pool id.
+ *
+ * Pool ids are assigned per pool type: at most 64 pools of the same type may exist concurrently - each with at most 65536 buffers.
+ * Handles must not be resolved concurrently to deletion of their pool.
+ */
+template <typename T, typename TBufferManagementPolicy>
+class UseCompactHandles
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  typedef T tManagedType;
+  typedef std::unique_ptr<T, UseCompactHandles> tPointer;
+
+  void operator()(T* p) const
+  {
+    static_assert(std::is_base_of<tBufferManagementInfo, T>::value, "Type T must be subclass of tBufferManagementInfo for this policy."); // static assertions are in methods to deal with incomplete types properly
+    NextGeneration(p);
+    TBufferManagementPolicy::RecycleBuffer(static_cast<tBufferManagementInfo&>(*p), p);
+  }
+
+  static tPointer AddBuffer(TBufferManagementPolicy& buffer_management, std::unique_ptr<tManagedType> && buffer)
+  {
+    static_assert(std::is_base_of<tBufferManagementInfo, T>::value, "Type T must be subclass of tBufferManagementInfo for this policy.");
+    buffer_management.AddBuffer(buffer.get(), *buffer);
+    return tPointer(buffer.release());
+  }
+
+  /*!
+   * Resolves handle and takes over ownership of buffer
+   *
+   * \param handle Handle obtained from ToHandle()
+   * \return Buffer that handle refers to - Null if handle is stale (or null)
+   */
+  static tPointer FromHandle(tBufferHandle handle)
+  {
+    auto slot = handle ? TBufferManagementPolicy::GetSlot(handle) : NULL;
+    uint32_t expected = (handle.GetGeneration() << 1) | 1;
+    if (slot && slot->state.compare_exchange_strong(expected, handle.GetGeneration() << 1, std::memory_order_acquire, std::memory_order_relaxed))
+    {
+      return tPointer(static_cast<T*>(slot->buffer));
+    }
+    return tPointer();
+  }
+
+  /*!
+   * Looks up buffer without taking over ownership.
+   * The result is only valid as long as the handle has not been resolved.
+   *
+   * \param handle Handle obtained from ToHandle()
+   * \return Buffer that handle refers to - NULL if handle is stale (or null)
+   */
+  static T* GetBuffer(tBufferHandle handle)
+  {
+    auto slot = handle ? TBufferManagementPolicy::GetSlot(handle) : NULL;
+    if (slot && slot->state.load(std::memory_order_acquire) == ((handle.GetGeneration() << 1) | 1))
+    {
+      return static_cast<T*>(slot->buffer);
+    }
+    return NULL;
+  }
+
+  static tPointer GetUnusedBuffer(TBufferManagementPolicy& buffer_management)
+  {
+    static_assert(std::is_base_of<tBufferManagementInfo, T>::value, "Type T must be subclass of tBufferManagementInfo for this policy.");
+    tBufferManagementInfo info;
+    return tPointer(buffer_management.GetUnusedBuffer(info));
+  }
+
+  template <typename TIterator>
+  static size_t GetUnusedBuffers(TBufferManagementPolicy& buffer_management, TIterator output, size_t count)
+  {
+    static_assert(std::is_base_of<tBufferManagementInfo, T>::value, "Type T must be subclass of tBufferManagementInfo for this policy.");
+    return buffer_management.GetUnusedBuffers(count, [&output](T* buffer, const tBufferManagementInfo&)
+    {
+      *output = tPointer(buffer);
+      ++output;
+    });
+  }
+
+  /*!
+   * Releases buffer from pointer without recycling it
+   * (for recycling it later, e.g. in a batch via TBufferManagementPolicy::RecycleBuffers)
+   *
+   * \param pointer Pointer to release buffer from (non-null). Is null after call.
+   * \return Buffer management info and buffer
+   */
+  static std::pair<tBufferManagementInfo, tManagedType*> ReleaseBuffer(tPointer& pointer)
+  {
+    static_assert(std::is_base_of<tBufferManagementInfo, T>::value, "Type T must be subclass of tBufferManagementInfo for this policy.");
+    T* buffer = pointer.release();
+    NextGeneration(buffer);
+    return std::pair<tBufferManagementInfo, tManagedType*>(static_cast<tBufferManagementInfo&>(*buffer), buffer);
+  }
+
+  /*!
+   * Converts pointer to compact handle. Ownership of buffer is passed to handle.
+   *
+   * \param pointer Pointer to buffer. Is null after call.
+   * \return Handle to buffer (null handle if pointer is null)
+   */
+  static tBufferHandle ToHandle(tPointer && pointer)
+  {
+    T* buffer = pointer.release();
+    if (!buffer)
+    {
+      return tBufferHandle();
+    }
+    tBufferHandle handle_slot = static_cast<tHandleBuffer&>(*buffer).handle_slot;
+    auto slot = TBufferManagementPolicy::GetSlot(handle_slot);
+    uint32_t generation = slot->state.load(std::memory_order_relaxed) >> 1;
+    slot->state.store((generation << 1) | 1, std::memory_order_release);
+    return tBufferHandle(handle_slot.GetPoolId(), handle_slot.GetIndex(), generation);
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*!
+   * Increments generation of buffer that is about to be recycled (invalidates all handles to it)
+   */
+  static void NextGeneration(T* buffer)
+  {
+    auto slot = TBufferManagementPolicy::GetSlot(static_cast<tHandleBuffer&>(*buffer).handle_slot);
+    uint32_t generation = slot->state.load(std::memory_order_relaxed) >> 1;
+    generation = generation == tBufferHandle::cMAX_GENERATION ? 1 : generation + 1;
+    slot->state.store(generation << 1, std::memory_order_relaxed); // published by recycling operation
+  }
+};
+
+/*!
+ * Buffer management type that tBufferPool uses with a recycling policy
+ * (recycling policies may need to extend the buffer management policy)
+ *
+ * TRecycling               Recycling policy
+ * TBufferManagementPolicy  Buffer management policy (instantiated)
+ */
+template <template <typename, typename> class TRecycling, typename TBufferManagementPolicy>
+struct tBufferManagementForRecyclingPolicy
+{
+  typedef TBufferManagementPolicy type;
+};
+
+template <typename TBufferManagementPolicy>
+struct tBufferManagementForRecyclingPolicy<UseCompactHandles, TBufferManagementPolicy>
+{
+  typedef HandleTableManagement<TBufferManagementPolicy> type;
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+
+#endif
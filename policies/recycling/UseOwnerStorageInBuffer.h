@@ -103,6 +103,31 @@ public:
     return tPointer(buffer_management.GetUnusedBuffer(info));
   }
 
+  template <typename TIterator>
+  static size_t GetUnusedBuffers(TBufferManagementPolicy& buffer_management, TIterator output, size_t count)
+  {
+    static_assert(std::is_base_of<tBufferManagementInfo, T>::value, "Type T must be subclass of tBufferManagementInfo for this policy.");
+    return buffer_management.GetUnusedBuffers(count, [&output](T* buffer, const tBufferManagementInfo&)
+    {
+      *output = tPointer(buffer);
+      ++output;
+    });
+  }
+
+  /*!
+   * Releases buffer from pointer without recycling it
+   * (for recycling it later, e.g. in a batch via TBufferManagementPolicy::RecycleBuffers)
+   *
+   * \param pointer Pointer to release buffer from (non-null). Is null after call.
+   * \return Buffer management info and buffer
+   */
+  static std::pair<tBufferManagementInfo, tManagedType*> ReleaseBuffer(tPointer& pointer)
+  {
+    static_assert(std::is_base_of<tBufferManagementInfo, T>::value, "Type T must be subclass of tBufferManagementInfo for this policy.");
+    T* buffer = pointer.release();
+    return std::pair<tBufferManagementInfo, tManagedType*>(static_cast<tBufferManagementInfo&>(*buffer), buffer);
+  }
+
 //----------------------------------------------------------------------
 // Private fields and methods
 //----------------------------------------------------------------------
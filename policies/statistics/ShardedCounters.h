@@ -0,0 +1,327 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/policies/statistics/ShardedCounters.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains ShardedCounters
+ *
+ * \b ShardedCounters
+ *
+ * Statistics policy that counts operations in sharded relaxed counters.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__policies__statistics__ShardedCounters_h__
+#define __rrlib__buffer_pools__policies__statistics__ShardedCounters_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/util/tNoncopyable.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tStatisticsSnapshot.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+namespace statistics
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Statistics in sharded counters
+/*!
+ * Statistics policy that counts operations in relaxed atomic counters.
+ * Threads are distributed among a fixed number of shards (each in a cache line of its own),
+ * so that threads hardly ever write to the same cache line.
+ *
+ * LATENCY_SAMPLING_INTERVAL  If non-zero, the acquire-to-recycle latency of every n-th buffer a thread obtains is
+ *                            sampled and added to a histogram. Recycling is only slowed down while samples are pending.
+ *                            Samples of buffers not recycled within cLATENCY_SAMPLE_EXPIRY_SECONDS are dropped
+ *                            (so that leaked or long-held buffers do not slow down recycling forever).
+ * TRACK_PEAK_IN_USE          Track maximum number of buffers in use at the same time.
+ *                            This requires a central counter that all threads write to.
+ */
+template <size_t LATENCY_SAMPLING_INTERVAL = 0, bool TRACK_PEAK_IN_USE = false>
+class ShardedCounters : private util::tNoncopyable
+{
+  enum { cSHARD_COUNT = 16 };
+  enum { cCACHE_LINE_SIZE = 64 };
+  enum { cLATENCY_SAMPLE_SLOTS = 32 };
+  enum { cLATENCY_SAMPLE_EXPIRY_SECONDS = 10 };
+
+  /*! Counters of one shard */
+  struct alignas(cCACHE_LINE_SIZE) tShard
+  {
+    std::atomic<size_t> acquisitions, misses, additions, recycles, claim_conflicts;
+
+    tShard() : acquisitions(0), misses(0), additions(0), recycles(0), claim_conflicts(0) {}
+  };
+
+  /*! Pending latency sample */
+  struct tLatencySample
+  {
+    /*! Sampled buffer - NULL if slot is free */
+    std::atomic<const void*> buffer;
+
+    /*! Time when buffer was obtained (nanoseconds since steady clock's epoch) - zero while sample is being started */
+    std::atomic<int64_t> start;
+
+    tLatencySample() : buffer(NULL), start(0) {}
+  };
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  ShardedCounters() :
+    shards(),
+    in_use(0),
+    peak_in_use(0),
+    pending_latency_samples(0),
+    latency_samples(),
+    latency_histogram()
+  {
+    for (auto & bucket : latency_histogram)
+    {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  /*!
+   * \return Snapshot of current statistics
+   */
+  tStatisticsSnapshot GetSnapshot() const
+  {
+    tStatisticsSnapshot snapshot;
+    for (auto & shard : shards)
+    {
+      snapshot.acquisitions += shard.acquisitions.load(std::memory_order_relaxed);
+      snapshot.misses += shard.misses.load(std::memory_order_relaxed);
+      snapshot.additions += shard.additions.load(std::memory_order_relaxed);
+      snapshot.recycles += shard.recycles.load(std::memory_order_relaxed);
+      snapshot.claim_conflicts += shard.claim_conflicts.load(std::memory_order_relaxed);
+    }
+    size_t obtained = snapshot.acquisitions + snapshot.additions;
+    snapshot.in_use = obtained > snapshot.recycles ? obtained - snapshot.recycles : 0;
+    snapshot.peak_in_use = peak_in_use.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < latency_histogram.size(); i++)
+    {
+      snapshot.latency_histogram[i] = latency_histogram[i].load(std::memory_order_relaxed);
+      snapshot.latency_samples += snapshot.latency_histogram[i];
+    }
+    return snapshot;
+  }
+
+  void OnAcquire(const void* buffer)
+  {
+    Increment(GetShard().acquisitions);
+    TrackInUse(1);
+    if (LATENCY_SAMPLING_INTERVAL)
+    {
+      static thread_local size_t countdown = LATENCY_SAMPLING_INTERVAL;
+      if (--countdown == 0)
+      {
+        countdown = LATENCY_SAMPLING_INTERVAL;
+        StartLatencySample(buffer);
+      }
+    }
+  }
+
+  void OnAdd()
+  {
+    Increment(GetShard().additions);
+    TrackInUse(1);
+  }
+
+  void OnClaimConflicts(size_t count)
+  {
+    if (count)
+    {
+      GetShard().claim_conflicts.fetch_add(count, std::memory_order_relaxed);
+    }
+  }
+
+  void OnMiss()
+  {
+    Increment(GetShard().misses);
+  }
+
+  void OnRecycle(const void* buffer)
+  {
+    Increment(GetShard().recycles);
+    TrackInUse(-1);
+    if (LATENCY_SAMPLING_INTERVAL && pending_latency_samples.load(std::memory_order_relaxed))
+    {
+      FinishLatencySample(buffer);
+    }
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Counter shards */
+  std::array<tShard, cSHARD_COUNT> shards;
+
+  /*! Number of buffers in use (only used if TRACK_PEAK_IN_USE is set) */
+  alignas(cCACHE_LINE_SIZE) std::atomic<ptrdiff_t> in_use;
+
+  /*! Maximum number of buffers in use (only used if TRACK_PEAK_IN_USE is set) */
+  std::atomic<size_t> peak_in_use;
+
+  /*! Number of pending latency samples */
+  alignas(cCACHE_LINE_SIZE) std::atomic<size_t> pending_latency_samples;
+
+  /*! Pending latency samples */
+  std::array<tLatencySample, cLATENCY_SAMPLE_SLOTS> latency_samples;
+
+  /*! Histogram of sampled latencies (see tStatisticsSnapshot::latency_histogram) */
+  std::array<std::atomic<size_t>, tStatisticsSnapshot::cLATENCY_HISTOGRAM_SIZE> latency_histogram;
+
+
+  static int64_t Now()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  void FinishLatencySample(const void* buffer)
+  {
+    for (auto & sample : latency_samples)
+    {
+      if (sample.buffer.load(std::memory_order_acquire) == buffer)
+      {
+        int64_t start = sample.start.load(std::memory_order_relaxed);
+        if (start && ReleaseLatencySample(sample, buffer)) // otherwise sample has just expired
+        {
+          int64_t latency = Now() - start;
+          size_t bucket = latency > 0 ? 63 - __builtin_clzll(static_cast<uint64_t>(latency)) : 0;
+          latency_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+      }
+    }
+  }
+
+  /*!
+   * \return Shard of current thread
+   */
+  tShard& GetShard()
+  {
+    static std::atomic<size_t> thread_count(0);
+    static thread_local size_t shard_index = thread_count.fetch_add(1, std::memory_order_relaxed) % cSHARD_COUNT;
+    return shards[shard_index];
+  }
+
+  static void Increment(std::atomic<size_t>& counter)
+  {
+    counter.fetch_add(1, std::memory_order_relaxed); // uncontended as long as shard is not shared
+  }
+
+  /*!
+   * Frees slot of latency sample
+   *
+   * \param sample Sample to free
+   * \param buffer Buffer of sample
+   * \return True if this thread freed the slot (false if another thread was faster)
+   */
+  bool ReleaseLatencySample(tLatencySample& sample, const void* buffer)
+  {
+    int64_t start = sample.start.load(std::memory_order_relaxed);
+    if (!start || !sample.start.compare_exchange_strong(start, 0, std::memory_order_relaxed))
+    {
+      return false;
+    }
+    sample.buffer.store(NULL, std::memory_order_release);
+    pending_latency_samples.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  void StartLatencySample(const void* buffer)
+  {
+    int64_t now = Now();
+    int64_t expiry = now - static_cast<int64_t>(cLATENCY_SAMPLE_EXPIRY_SECONDS) * 1000000000;
+    bool started = false;
+    for (auto & sample : latency_samples)
+    {
+      const void* sampled_buffer = sample.buffer.load(std::memory_order_acquire);
+      if (sampled_buffer)
+      {
+        int64_t start = sample.start.load(std::memory_order_relaxed);
+        if (start && start < expiry)
+        {
+          ReleaseLatencySample(sample, sampled_buffer); // drop stale sample
+        }
+        continue;
+      }
+      const void* expected = NULL;
+      if ((!started) && sample.buffer.compare_exchange_strong(expected, buffer, std::memory_order_acq_rel))
+      {
+        sample.start.store(now, std::memory_order_relaxed);
+        pending_latency_samples.fetch_add(1, std::memory_order_relaxed);
+        started = true;
+      }
+    }
+    // if all slots are occupied: skip sample
+  }
+
+  void TrackInUse(ptrdiff_t delta)
+  {
+    if (TRACK_PEAK_IN_USE)
+    {
+      ptrdiff_t current = in_use.fetch_add(delta, std::memory_order_relaxed) + delta;
+      size_t peak = peak_in_use.load(std::memory_order_relaxed);
+      while (current > 0 && static_cast<size_t>(current) > peak && !peak_in_use.compare_exchange_weak(peak, current, std::memory_order_relaxed));
+    }
+  }
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+}
+
+
+#endif
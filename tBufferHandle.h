@@ -0,0 +1,156 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tBufferHandle.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tBufferHandle
+ *
+ * \b tBufferHandle
+ *
+ * Compact (32 bit) handle to a pooled buffer.
+ * Handles are obtained and resolved with the UseCompactHandles recycling policy.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tBufferHandle_h__
+#define __rrlib__buffer_pools__tBufferHandle_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <cstdint>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Compact handle to pooled buffer
+/*!
+ * Handle to a buffer from a buffer pool with the UseCompactHandles recycling policy.
+ * Encodes pool id, slot index and generation in 32 bits:
+ *
+ *   | pool id (6 bits) | slot index (16 bits) | generation (10 bits) |
+ *
+ * Therefore, handles fit into packed message headers, 32/64 bit atomic slots and index-based data structures.
+ * The generation is used to detect stale handles (see UseCompactHandles).
+ * The raw value 0 is never a valid handle (generations start at 1).
+ */
+class tBufferHandle
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  enum { cGENERATION_BITS = 10 };
+  enum { cINDEX_BITS = 16 };
+  enum { cPOOL_ID_BITS = 6 };
+
+  enum : uint32_t { cMAX_GENERATION = (1u << cGENERATION_BITS) - 1 };
+  enum : uint32_t { cMAX_INDEX = (1u << cINDEX_BITS) - 1 };
+  enum : uint32_t { cMAX_POOL_ID = (1u << cPOOL_ID_BITS) - 1 };
+
+  /*! Creates null handle */
+  tBufferHandle() : raw_value(0) {}
+
+  explicit tBufferHandle(uint32_t raw_value) : raw_value(raw_value) {}
+
+  tBufferHandle(uint32_t pool_id, uint32_t index, uint32_t generation) :
+    raw_value((pool_id << (cINDEX_BITS + cGENERATION_BITS)) | (index << cGENERATION_BITS) | generation)
+  {}
+
+  uint32_t GetGeneration() const
+  {
+    return raw_value & cMAX_GENERATION;
+  }
+
+  uint32_t GetIndex() const
+  {
+    return (raw_value >> cGENERATION_BITS) & cMAX_INDEX;
+  }
+
+  uint32_t GetPoolId() const
+  {
+    return raw_value >> (cINDEX_BITS + cGENERATION_BITS);
+  }
+
+  /*!
+   * \return Raw 32 bit value (e.g. for storing handle in messages or atomic variables)
+   */
+  uint32_t GetRawValue() const
+  {
+    return raw_value;
+  }
+
+  explicit operator bool() const
+  {
+    return raw_value != 0;
+  }
+
+  bool operator == (const tBufferHandle& other) const
+  {
+    return raw_value == other.raw_value;
+  }
+
+  bool operator != (const tBufferHandle& other) const
+  {
+    return raw_value != other.raw_value;
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Pool id, slot index and generation */
+  uint32_t raw_value;
+};
+
+static_assert(sizeof(tBufferHandle) == 4, "tBufferHandle must have 32 bits");
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
@@ -60,11 +60,20 @@ namespace buffer_pools
 //----------------------------------------------------------------------
 namespace management
 {
-template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename TBufferDeleter, typename>
+template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename TBufferDeleter, typename, typename, typename>
 class ArrayAndFlagBased;
 
+template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename TBufferDeleter, typename>
+class BitmapBased;
+
 template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename TBufferDeleter>
 class QueueBased;
+
+template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename TBufferDeleter>
+class QueueBasedWithThreadLocalCache;
+
+template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename TBufferDeleter>
+class StackBased;
 }
 
 //----------------------------------------------------------------------
@@ -91,12 +100,21 @@ public:
 //----------------------------------------------------------------------
 private:
 
-  template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename TBufferDeleter, typename>
+  template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename TBufferDeleter, typename, typename, typename>
   friend class management::ArrayAndFlagBased;
 
+  template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename TBufferDeleter, typename>
+  friend class management::BitmapBased;
+
   template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename TBufferDeleter>
   friend class management::QueueBased;
 
+  template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename TBufferDeleter>
+  friend class management::QueueBasedWithThreadLocalCache;
+
+  template <typename T, concurrent_containers::tConcurrency CONCURRENCY, typename TBufferDeleter>
+  friend class management::StackBased;
+
   /*!
    * Information set and interpreted by buffer management policy.
    * The buffer management policy can choose to use either of union members.
@@ -40,16 +40,33 @@
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
 #include "rrlib/logging/messages.h"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
 //----------------------------------------------------------------------
 #include "rrlib/buffer_pools/tBufferContainer.h"
+#include "rrlib/buffer_pools/tBufferSlab.h"
+#include "rrlib/buffer_pools/tRecyclingBatch.h"
 #include "rrlib/buffer_pools/policies/deleting/CollectGarbage.h"
 #include "rrlib/buffer_pools/policies/deleting/ComplainOnMissingBuffers.h"
+#include "rrlib/buffer_pools/policies/deleting/DeleteOnLastReturn.h"
 #include "rrlib/buffer_pools/policies/management/ArrayAndFlagBased.h"
+#include "rrlib/buffer_pools/policies/management/BitmapBased.h"
 #include "rrlib/buffer_pools/policies/management/QueueBased.h"
+#include "rrlib/buffer_pools/policies/management/QueueBasedWithThreadLocalCache.h"
+#include "rrlib/buffer_pools/policies/management/StackBased.h"
+#include "rrlib/buffer_pools/policies/management/WithLeakTracking.h"
+#include "rrlib/buffer_pools/policies/management/WithStatistics.h"
+#include "rrlib/buffer_pools/policies/management/WithWaiting.h"
 #include "rrlib/buffer_pools/policies/recycling/StoreOwnerInUniquePointer.h"
+#include "rrlib/buffer_pools/policies/recycling/UseCompactHandles.h"
 #include "rrlib/buffer_pools/policies/recycling/UseOwnerStorageInBuffer.h"
 #include "rrlib/buffer_pools/policies/recycling/UseBufferContainer.h"
 
@@ -113,8 +130,9 @@ class tBufferPool : private rrlib::util::tNoncopyable
 //----------------------------------------------------------------------
 public:
 
-  /*! Buffer management backend */
-  typedef TBufferManagementPolicy<typename TRecycling<T, int>::tManagedType, CONCURRENCY, TBufferDeleter, TBufferManagementPolicyArgs...> tBufferManagement;
+  /*! Buffer management backend (some deleting and recycling policies extend the management policy - e.g. DeleteOnLastReturn and UseCompactHandles) */
+  typedef typename deleting::tBufferManagementForDeletingPolicy < TDeletingPolicy, typename recycling::tBufferManagementForRecyclingPolicy < TRecycling,
+          TBufferManagementPolicy<typename TRecycling<T, int>::tManagedType, CONCURRENCY, TBufferDeleter, TBufferManagementPolicyArgs... >>::type >::type tBufferManagement;
 
   /*! Recycling policy */
   typedef TRecycling<T, tBufferManagement> tRecycler;
@@ -154,6 +172,136 @@ public:
     return tRecycler::AddBuffer(buffer_management.GetBufferManagement(), std::forward<std::unique_ptr<tManagedType>>(buffer));
   }
 
+  /*!
+   * Adds many new buffers to pool - e.g. to populate pool at startup.
+   * Management structures are prepared for all new buffers once and
+   * buffers are made available in bulk (see RecycleBuffers).
+   * Optionally, buffers are constructed in parallel by multiple threads.
+   *
+   * \param count Number of buffers to add
+   * \param factory Function object that returns a new buffer as std::unique_ptr<tManagedType>.
+   *                Is called from construction threads concurrently if construction_threads > 1.
+   * \param construction_threads Number of threads to construct buffers with (1 constructs all buffers in calling thread)
+   * \throw Any exception thrown by factory or std::system_error if construction threads cannot be created (no buffers are added in these cases)
+   */
+  template <typename TFactory>
+  void Reserve(size_t count, TFactory factory, unsigned int construction_threads = 1)
+  {
+    std::vector<std::unique_ptr<tManagedType>> buffers(count);
+    if (construction_threads <= 1 || count < 2)
+    {
+      for (auto it = buffers.begin(); it != buffers.end(); ++it)
+      {
+        *it = factory();
+        assert(*it && "Factory must not return null buffers");
+      }
+    }
+    else
+    {
+      std::vector<std::thread> threads;
+      threads.reserve(construction_threads);
+      std::vector<std::exception_ptr> exceptions(construction_threads);
+      try
+      {
+        for (unsigned int i = 0; i < construction_threads; i++)
+        {
+          threads.emplace_back([&, i]()
+          {
+            try
+            {
+              for (size_t j = i; j < count; j += construction_threads)
+              {
+                buffers[j] = factory();
+                assert(buffers[j] && "Factory must not return null buffers");
+              }
+            }
+            catch (...)
+            {
+              exceptions[i] = std::current_exception();
+            }
+          });
+        }
+      }
+      catch (...)
+      {
+        // thread creation failed: threads already started refer to local variables
+        for (auto & thread : threads)
+        {
+          thread.join();
+        }
+        throw;
+      }
+      for (auto & thread : threads)
+      {
+        thread.join();
+      }
+      for (auto & exception : exceptions)
+      {
+        if (exception)
+        {
+          std::rethrow_exception(exception);
+        }
+      }
+    }
+
+    tBufferManagement& buffer_management = this->buffer_management.GetBufferManagement();
+    buffer_management.Reserve(count);
+    tRecyclingBatch<tBufferPool> batch;
+    for (auto it = buffers.begin(); it != buffers.end(); ++it)
+    {
+      batch.Add(tRecycler::AddBuffer(buffer_management, std::move(*it)));
+    }
+  }
+
+  /*!
+   * Adds new buffers to pool that are allocated in large contiguous blocks (see tBufferSlab)
+   * and constructed in place. Requires tBufferSlab<tManagedType, TStorage>::tDeleter as TBufferDeleter
+   * (TStorage determines where slabs are allocated - e.g. in huge pages with tHugePageSlabStorage).
+   * Buffers of such pools must only be added via this method.
+   * Slabs are freed when the deleting policy finally deletes the pool's buffers.
+   *
+   * As slabs are not shared among calls, count should ideally be a multiple of
+   * tBufferSlab<tManagedType, TStorage>::cBUFFERS_PER_SLAB (or considerably larger) for minimum waste of memory.
+   *
+   * \param count Number of buffers to add
+   * \param args Arguments to pass to constructor of every buffer
+   * \return Memory that slabs created in this call are backed by (least TLB-friendly backing if slabs differ - e.g. when reserved huge pages run out).
+   *         tSlabBacking::HEAP if count is zero (no slabs are created).
+   * \throw std::bad_alloc if no memory could be allocated. Any exception thrown by constructor of buffers (slabs created before are added to pool).
+   */
+  template <typename ... TArgs>
+  tSlabBacking AddSlabBuffers(size_t count, const TArgs& ... args)
+  {
+    static_assert(tIsBufferSlabDeleter<TBufferDeleter, tManagedType>::value, "Buffer pool must use tBufferSlab<tManagedType, TStorage>::tDeleter to delete buffers");
+    typedef typename TBufferDeleter::tSlab tSlab;
+    tBufferManagement& buffer_management = this->buffer_management.GetBufferManagement();
+    buffer_management.Reserve(count);
+    tRecyclingBatch<tBufferPool> batch;
+    tSlabBacking backing = tSlabBacking::HEAP;
+    bool slab_created = false;
+    while (count > 0)
+    {
+      size_t slab_buffer_count = std::min<size_t>(count, tSlab::cBUFFERS_PER_SLAB);
+      tSlabBacking slab_backing = tSlab::Create(slab_buffer_count, [&](tManagedType * buffer)
+      {
+        std::unique_ptr<tManagedType> pointer(buffer);
+        try
+        {
+          batch.Add(tRecycler::AddBuffer(buffer_management, std::move(pointer)));
+        }
+        catch (...)
+        {
+          pointer.release(); // buffer is in slab: tSlab::Create deletes it with tDeleter
+          throw;
+        }
+      }, args...);
+      backing = slab_created ? std::max(backing, slab_backing) : slab_backing;
+      slab_created = true;
+      count -= slab_buffer_count;
+    }
+    return backing;
+  }
+
   /*!
    * Obtain pointer to unused buffer in pool.
    * The buffer will be marked in use as long as the returned unique_ptr
@@ -171,6 +319,162 @@ public:
     return tRecycler::GetUnusedBuffer(buffer_management.GetBufferManagement());
   }
 
+  /*!
+   * Obtain pointer to unused buffer in pool.
+   * If there is no unused buffer, waits until one is recycled - or the timeout expires.
+   * Waiting threads do not consume CPU time.
+   * (requires a management policy that notifies waiting threads - see management::WithWaiting)
+   *
+   * \param timeout Maximum time to wait
+   * \return Unused Buffer - Null if no buffer became available before timeout
+   */
+  template <typename TRep, typename TPeriod>
+  tPointer GetUnusedBuffer(const std::chrono::duration<TRep, TPeriod>& timeout)
+  {
+    return GetUnusedBufferUntil(std::chrono::steady_clock::now() + timeout);
+  }
+
+  /*!
+   * Obtain pointer to unused buffer in pool.
+   * If there is no unused buffer, waits until one is recycled - or the deadline is reached
+   * (see GetUnusedBuffer(timeout)).
+   *
+   * \param deadline Time point at which to stop waiting
+   * \return Unused Buffer - Null if no buffer became available before deadline
+   */
+  template <typename TClock, typename TDuration>
+  tPointer GetUnusedBufferUntil(const std::chrono::time_point<TClock, TDuration>& deadline)
+  {
+    tPointer buffer = GetUnusedBuffer();
+    while (!buffer)
+    {
+      tEventCount& recycle_event = buffer_management.GetBufferManagement().RecycleEvent();
+      unsigned int key = recycle_event.PrepareWait();
+      buffer = GetUnusedBuffer();
+      if (buffer)
+      {
+        recycle_event.CancelWait();
+        break;
+      }
+      if (!recycle_event.Wait(key, deadline))
+      {
+        return GetUnusedBuffer();
+      }
+      buffer = GetUnusedBuffer();
+    }
+    return buffer;
+  }
+
+  /*!
+   * Obtain multiple unused buffers from pool in one operation.
+   * This is typically more efficient than calling GetUnusedBuffer() in a loop.
+   * (management::QueueBased provides no bulk operation - so buffers are obtained one by one with this policy)
+   *
+   * \param begin Begin of output range of tPointer objects to store buffers in
+   * \param end End of output range. Up to (end - begin) buffers are obtained.
+   * \param all_or_nothing If true, no buffers are obtained if pool does not contain enough unused buffers.
+   *                       (buffers obtained so far are returned to pool; so callers never hold a partial set)
+   * \return Number of buffers obtained. They are stored at the beginning of the output range.
+   */
+  template <typename TIterator>
+  size_t GetUnusedBuffers(TIterator begin, TIterator end, bool all_or_nothing = false)
+  {
+    size_t count = std::distance(begin, end);
+    size_t obtained = ObtainUnusedBuffers(begin, count, decltype(HasBatchAcquisition<tBufferManagement>(nullptr))());
+    if (all_or_nothing && obtained < count)
+    {
+      for (; obtained > 0; obtained--, ++begin)
+      {
+        begin->reset();
+      }
+      return 0;
+    }
+    return obtained;
+  }
+
+  /*!
+   * Recycles multiple buffers in one operation.
+   * This is typically more efficient than letting the pointers go out of scope one at a time
+   * (see tRecyclingBatch for details).
+   *
+   * \param begin Begin of range of tPointer objects with buffers to recycle (buffers may originate from different pools of this type)
+   * \param end End of range. All pointers in range are empty after call.
+   */
+  template <typename TIterator>
+  static void RecycleBuffers(TIterator begin, TIterator end)
+  {
+    tRecyclingBatch<tBufferPool> batch;
+    for (; begin != end; ++begin)
+    {
+      batch.Add(std::move(*begin));
+    }
+  }
+
+  /*!
+   * \return Number of buffers in pool (including buffers in use)
+   */
+  size_t GetBufferCount()
+  {
+    return buffer_management.GetBufferManagement().GetBufferCount();
+  }
+
+  /*!
+   * Determines number of unused buffers in pool - without obtaining them
+   * (so, in contrast to GetUnusedBuffers(), this does not affect other threads or statistics).
+   * Buffers may be obtained and recycled concurrently - so the result is a snapshot only.
+   *
+   * \return Number of unused buffers in pool
+   */
+  size_t GetUnusedBufferCount()
+  {
+    return buffer_management.GetBufferManagement().GetUnusedBufferCount();
+  }
+
+  /*!
+   * Removes unused buffers from pool and deletes them - e.g. to release memory after a load spike.
+   *
+   * \param count Maximum number of buffers to remove
+   * \return Number of buffers removed (less than count if there are not enough unused buffers)
+   */
+  size_t RemoveUnusedBuffers(size_t count)
+  {
+    return buffer_management.GetBufferManagement().RemoveUnusedBuffers(count);
+  }
+
+  /*!
+   * Removes unused buffers from pool until it contains the specified number of buffers
+   * (or there are no more unused buffers).
+   *
+   * \param target_buffer_count Number of buffers that pool should contain after call
+   * \return Number of buffers removed
+   */
+  size_t ShrinkTo(size_t target_buffer_count)
+  {
+    size_t buffer_count = GetBufferCount();
+    return buffer_count > target_buffer_count ? RemoveUnusedBuffers(buffer_count - target_buffer_count) : 0;
+  }
+
+  /*!
+   * Prints records of buffers that are currently in use
+   * (only available with management policies that track outstanding buffers - see management::WithLeakTracking)
+   *
+   * \param minimum_age Only buffers that have been in use for at least this duration are printed
+   * \return Number of buffers printed
+   */
+  size_t DumpOutstandingBuffers(std::chrono::nanoseconds minimum_age = std::chrono::nanoseconds::zero())
+  {
+    return buffer_management.GetBufferManagement().DumpOutstandingBuffers(minimum_age);
+  }
+
+  /*!
+   * \return Snapshot of statistics of this pool
+   * (only available with management policies that collect statistics - see management::WithStatistics)
+   */
+  tStatisticsSnapshot GetStatistics()
+  {
+    return buffer_management.GetBufferManagement().GetStatistics();
+  }
+
   /*!
    * \return Returns internal buffer management backend for special manual tweaking of
    * buffer pool. In most cases, it should not be necessary to access internals.
@@ -188,6 +492,33 @@ private:
   /*! Buffer Pool backend */
   TDeletingPolicy<tBufferManagement> buffer_management;
 
+  /*! Management policies without bulk operation declare cNO_BATCH_ACQUISITION */
+  template <typename U>
+  static std::false_type HasBatchAcquisition(decltype(U::cNO_BATCH_ACQUISITION)*);
+  template <typename U>
+  static std::true_type HasBatchAcquisition(...);
+
+  template <typename TIterator>
+  size_t ObtainUnusedBuffers(TIterator begin, size_t count, std::true_type batch_acquisition)
+  {
+    return tRecycler::GetUnusedBuffers(buffer_management.GetBufferManagement(), begin, count);
+  }
+
+  template <typename TIterator>
+  size_t ObtainUnusedBuffers(TIterator begin, size_t count, std::false_type batch_acquisition)
+  {
+    size_t obtained = 0;
+    for (; obtained < count; obtained++, ++begin)
+    {
+      *begin = GetUnusedBuffer();
+      if (!(*begin))
+      {
+        break;
+      }
+    }
+    return obtained;
+  }
+
 };
 
 //----------------------------------------------------------------------
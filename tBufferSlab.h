@@ -0,0 +1,227 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tBufferSlab.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tBufferSlab
+ *
+ * \b tBufferSlab
+ *
+ * Large contiguous block of memory that buffers of a buffer pool are constructed in.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tBufferSlab_h__
+#define __rrlib__buffer_pools__tBufferSlab_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <atomic>
+#include <type_traits>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tSlabStorage.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Slab of buffers
+/*!
+ * Large contiguous block of memory that buffers are constructed in.
+ * Compared to allocating every buffer separately, buffers of a pool are
+ * adjacent in memory - which is considerably more TLB- and prefetch-friendly.
+ *
+ * Slabs are aligned to their size. Therefore, the slab of a buffer can
+ * be determined from the buffer's address without storing any additional information.
+ * A slab is freed as a whole when the last of its buffers is deleted
+ * (this happens when the deleting policy finally tears down the buffer pool).
+ *
+ * To use slabs with a buffer pool, tBufferSlab<tManagedType, TStorage>::tDeleter must be
+ * specified as TBufferDeleter and buffers must be added via tBufferPool::AddSlabBuffers().
+ *
+ * T         Type of buffers in slab (tManagedType of buffer pool - e.g. tBufferContainer<T> with UseBufferContainer recycling policy)
+ * TStorage  Where slabs are allocated (tHeapSlabStorage or tHugePageSlabStorage<...>) - also determines slab size
+ */
+template <typename T, typename TStorage = tHeapSlabStorage>
+class tBufferSlab
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! Where slabs are allocated */
+  typedef TStorage tStorage;
+
+  /*!
+   * Deleter for buffers in slabs (to be used as TBufferDeleter of buffer pool).
+   * Destructs buffer and frees slab when its last buffer is deleted.
+   */
+  struct tDeleter
+  {
+    typedef tBufferSlab tSlab;
+
+    void operator()(T* buffer) const
+    {
+      buffer->~T();
+      tBufferSlab* slab = reinterpret_cast<tBufferSlab*>(reinterpret_cast<size_t>(buffer) & ~(cSLAB_SIZE - 1));
+      if (slab->buffer_count.fetch_sub(1) == 1)
+      {
+        slab->~tBufferSlab();
+        TStorage::Free(slab);
+      }
+    }
+  };
+
+  /*! Size of slabs in bytes (power of two) */
+  enum { cSLAB_SIZE = TStorage::cSLAB_SIZE };
+
+  /*! Offset of first buffer in slab (buffers are placed directly behind slab header) */
+  enum { cBUFFER_OFFSET = ((sizeof(std::atomic<size_t>) + alignof(T) - 1) / alignof(T)) * alignof(T) };
+
+  /*! Maximum number of buffers per slab */
+  enum { cBUFFERS_PER_SLAB = (cSLAB_SIZE - cBUFFER_OFFSET) / sizeof(T) };
+
+  static_assert(cBUFFERS_PER_SLAB > 0, "Buffer type is too large for slabs (large buffers hardly benefit from them anyway)");
+
+  /*!
+   * Creates slab with the specified number of buffers and constructs buffers in place.
+   * The buffers are owned by the caller afterwards and must be deleted using tDeleter.
+   *
+   * \param count Number of buffers to create (1 to cBUFFERS_PER_SLAB)
+   * \param output Function that is called with each created buffer (T*) - e.g. to add buffer to buffer pool
+   * \param args Arguments to pass to constructor of every buffer
+   * \return Memory that slab is backed by
+   * \throw std::bad_alloc if slab could not be allocated. Any exception thrown by T's constructor (no buffers are created in this case).
+   *        Any exception thrown by output (buffers not handed out successfully are deleted - the slab is freed if output never succeeded).
+   */
+  template <typename TFunction, typename ... TArgs>
+  static tSlabBacking Create(size_t count, TFunction output, const TArgs& ... args)
+  {
+    assert(count > 0 && count <= static_cast<size_t>(cBUFFERS_PER_SLAB));
+    tSlabBacking backing = tSlabBacking::HEAP;
+    void* memory = TStorage::Allocate(backing);
+    tBufferSlab* slab = new(memory) tBufferSlab();
+    T* buffers = slab->Buffers();
+    size_t constructed = 0;
+    try
+    {
+      for (; constructed < count; constructed++)
+      {
+        new(&buffers[constructed]) T(args...);
+      }
+    }
+    catch (...)
+    {
+      for (size_t i = 0; i < constructed; i++)
+      {
+        buffers[i].~T();
+      }
+      slab->~tBufferSlab();
+      TStorage::Free(slab);
+      throw;
+    }
+
+    slab->buffer_count.store(count);
+    size_t handed_out = 0;
+    try
+    {
+      for (; handed_out < count; handed_out++)
+      {
+        output(&buffers[handed_out]);
+      }
+    }
+    catch (...)
+    {
+      for (size_t i = handed_out; i < count; i++)
+      {
+        tDeleter()(&buffers[i]); // frees slab with last buffer
+      }
+      throw;
+    }
+    return backing;
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Number of buffers in this slab that have not been deleted yet */
+  std::atomic<size_t> buffer_count;
+
+
+  tBufferSlab() : buffer_count(0)
+  {}
+
+  /*!
+   * \return Pointer to first buffer in slab
+   */
+  T* Buffers()
+  {
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(this) + cBUFFER_OFFSET);
+  }
+};
+
+/*!
+ * Type trait: Is TDeleter tBufferSlab<T, TStorage>::tDeleter (with any TStorage)?
+ */
+template <typename TDeleter, typename T, typename TEnable = void>
+struct tIsBufferSlabDeleter : std::false_type
+{};
+
+template <typename TDeleter, typename T>
+struct tIsBufferSlabDeleter < TDeleter, T, typename std::enable_if < std::is_same < TDeleter, typename tBufferSlab<T, typename TDeleter::tSlab::tStorage>::tDeleter >::value >::type > : std::true_type
+{};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
@@ -0,0 +1,114 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tClaimConflictCounter.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tClaimConflictCounter
+ *
+ * \b tClaimConflictCounter
+ *
+ * Counts how often the current thread lost a race for an unused buffer.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tClaimConflictCounter_h__
+#define __rrlib__buffer_pools__tClaimConflictCounter_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <cstddef>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Thread-local counter for claim conflicts
+/*!
+ * Management policies that claim unused buffers with atomic operations (e.g. ArrayAndFlagBased)
+ * increment this counter whenever another thread was faster and the operation needs to be retried.
+ * Statistics policies read it before and after acquiring buffers.
+ *
+ * The counter is only touched in the (already slow) conflict case.
+ */
+class tClaimConflictCounter
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*!
+   * \return Number of claim conflicts of the current thread so far
+   */
+  static size_t Get()
+  {
+    return Counter();
+  }
+
+  /*!
+   * Increments claim conflict counter of the current thread
+   */
+  static void Increment()
+  {
+    Counter()++;
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  static size_t& Counter()
+  {
+    static thread_local size_t counter = 0;
+    return counter;
+  }
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
@@ -0,0 +1,180 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tEventCount.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tEventCount
+ *
+ * \b tEventCount
+ *
+ * Event count that threads waiting for recycled buffers park on.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tEventCount_h__
+#define __rrlib__buffer_pools__tEventCount_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/thread/tConditionVariable.h"
+#include "rrlib/util/tNoncopyable.h"
+#include <atomic>
+#include <chrono>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Event count for threads waiting for recycled buffers
+/*!
+ * Lets threads wait for buffers being recycled - without burning CPU time.
+ *
+ * Waiting thread:
+ *  1) key = PrepareWait()
+ *  2) check condition (try to obtain buffer) once more - if successful: CancelWait()
+ *  3) Wait(key, deadline)
+ *
+ * Recycling thread:
+ *  1) make buffer available with sequentially consistent atomic operation
+ *  2) Notify()
+ *
+ * Notify() is a single atomic load if no thread is waiting.
+ * Only waiting and waking up threads involve the mutex.
+ */
+class tEventCount : private util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  tEventCount() :
+    waiters(0),
+    epoch(0),
+    mutex(),
+    condition_variable(mutex)
+  {}
+
+  /*!
+   * Cancels wait that was prepared with PrepareWait()
+   */
+  void CancelWait()
+  {
+    waiters.fetch_sub(1);
+  }
+
+  /*!
+   * Wakes up all waiting threads (if there are any)
+   */
+  void Notify()
+  {
+    if (waiters.load() != 0)
+    {
+      thread::tLock lock(mutex);
+      epoch.fetch_add(1);
+      condition_variable.NotifyAll(lock);
+    }
+  }
+
+  /*!
+   * Announces that calling thread is about to wait.
+   * Condition must be checked once more after calling this.
+   *
+   * \return Key to pass to Wait()
+   */
+  unsigned int PrepareWait()
+  {
+    waiters.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return epoch.load();
+  }
+
+  /*!
+   * Waits until Notify() is called (if it has not been called since PrepareWait() already) or deadline is reached
+   *
+   * \param key Key returned by PrepareWait()
+   * \param deadline Time point at which to stop waiting
+   * \return True if Notify() was called - false if deadline was reached
+   */
+  template <typename TClock, typename TDuration>
+  bool Wait(unsigned int key, const std::chrono::time_point<TClock, TDuration>& deadline)
+  {
+    thread::tLock lock(mutex);
+    while (epoch.load() == key)
+    {
+      auto now = TClock::now();
+      if (now >= deadline)
+      {
+        break;
+      }
+      condition_variable.Wait(lock, std::chrono::duration_cast<time::tDuration>(deadline - now), false);
+    }
+    bool notified = epoch.load() != key;
+    waiters.fetch_sub(1);
+    return notified;
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Number of threads that are waiting or about to wait */
+  std::atomic<unsigned int> waiters;
+
+  /*! Incremented whenever waiting threads are notified */
+  std::atomic<unsigned int> epoch;
+
+  /*! Mutex and condition variable for parking waiting threads */
+  thread::tMutex mutex;
+  thread::tConditionVariable condition_variable;
+
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
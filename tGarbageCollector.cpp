@@ -0,0 +1,127 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tGarbageCollector.cpp
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ */
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tGarbageCollector.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/logging/messages.h"
+#include "rrlib/thread/tLoopThread.h"
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+
+class tGarbageCollector::tCollectorThread : public thread::tLoopThread
+{
+public:
+  tCollectorThread(tGarbageCollector& collector, std::chrono::nanoseconds period) :
+    thread::tLoopThread(period, false),
+    collector(collector)
+  {}
+
+  virtual void MainLoopCallback() override
+  {
+    collector.CollectGarbage();
+  }
+
+private:
+  tGarbageCollector& collector;
+};
+
+tGarbageCollector::tGarbageCollector(std::chrono::nanoseconds period, size_t max_pools_per_period) :
+  max_pools_per_period(max_pools_per_period),
+  mutex(),
+  totals(),
+  collector_thread(new tCollectorThread(*this, period))
+{
+  collector_thread->Start();
+}
+
+tGarbageCollector::~tGarbageCollector()
+{
+  collector_thread->StopThread();
+  collector_thread->Join();
+}
+
+void tGarbageCollector::CollectGarbage()
+{
+  tGarbageFromDeletedBufferPools::tCollectionResult result = tGarbageFromDeletedBufferPools::DeleteGarbage(max_pools_per_period);
+  if (result.reclaimed_buffers)
+  {
+    RRLIB_LOG_PRINT(DEBUG, "Reclaimed ", result.reclaimed_pools, " pools and ", result.reclaimed_buffers, " buffers (", result.reclaimed_bytes, " bytes). ", result.remaining_pools, " pools remain.");
+  }
+  thread::tLock lock(mutex);
+  totals.reclaimed_pools += result.reclaimed_pools;
+  totals.reclaimed_buffers += result.reclaimed_buffers;
+  totals.reclaimed_bytes += result.reclaimed_bytes;
+  totals.remaining_pools = result.remaining_pools;
+}
+
+tGarbageFromDeletedBufferPools::tCollectionResult tGarbageCollector::GetTotals()
+{
+  thread::tLock lock(mutex);
+  return totals;
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
@@ -0,0 +1,135 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tGarbageCollector.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tGarbageCollector
+ *
+ * \b tGarbageCollector
+ *
+ * Background thread that periodically deletes garbage from deleted buffer pools.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tGarbageCollector_h__
+#define __rrlib__buffer_pools__tGarbageCollector_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/util/tNoncopyable.h"
+#include "rrlib/thread/tThread.h"
+#include <chrono>
+#include <limits>
+#include <memory>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tGarbageFromDeletedBufferPools.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Garbage collector for deleted buffer pools
+/*!
+ * Optional service that calls tGarbageFromDeletedBufferPools::DeleteGarbage() periodically
+ * in a background thread - so that no other component needs to take care of this.
+ * Reclaimed pools, buffers and memory are logged and accumulated.
+ *
+ * Real-time loops that rather delete garbage themselves can call the bounded-time
+ * tGarbageFromDeletedBufferPools::DeleteGarbage(max_pools, time_budget) instead.
+ */
+class tGarbageCollector : private util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*!
+   * Starts background thread
+   *
+   * \param period Period in which garbage is deleted
+   * \param max_pools_per_period Maximum number of pools to check per period (see tGarbageFromDeletedBufferPools::DeleteGarbage)
+   */
+  tGarbageCollector(std::chrono::nanoseconds period, size_t max_pools_per_period = std::numeric_limits<size_t>::max());
+
+  /*!
+   * Stops background thread
+   */
+  ~tGarbageCollector();
+
+  /*!
+   * \return Pools, buffers and memory reclaimed by this collector so far (remaining_pools is the number after last period)
+   */
+  tGarbageFromDeletedBufferPools::tCollectionResult GetTotals();
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Background thread (loop thread that calls CollectGarbage() once per period) */
+  class tCollectorThread;
+
+  /*! Maximum number of pools to check per period */
+  const size_t max_pools_per_period;
+
+  /*! Mutex for totals */
+  thread::tMutex mutex;
+
+  /*! Pools, buffers and memory reclaimed so far */
+  tGarbageFromDeletedBufferPools::tCollectionResult totals;
+
+  /*! Background thread */
+  std::unique_ptr<tCollectorThread> collector_thread;
+
+
+  /*! Deletes garbage - called once per period by background thread */
+  void CollectGarbage();
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
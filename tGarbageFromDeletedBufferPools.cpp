@@ -33,6 +33,8 @@
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
 #include "rrlib/thread/tThread.h"
+#include <algorithm>
+#include <limits>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
@@ -68,20 +70,34 @@ namespace buffer_pools
 //----------------------------------------------------------------------
 namespace internal
 {
+/*!
+ * Pools added since garbage was deleted last (lock-free stack linked via next_garbage).
+ * Constant-initialized - so it can be used at any time without allocating memory.
+ */
+static std::atomic<tGarbageFromDeletedBufferPools*> added_pools(nullptr);
+
 struct tDeletionList
 {
-  /*! Mutex to synchronize access on list */
+  /*! Mutex for threads that delete garbage */
   rrlib::thread::tMutex mutex;
 
-  /*! List with pools that have not been completely deleted yet */
-  std::list<tGarbageFromDeletedBufferPools*> garbage_pools;
+  /*! First pool in list of pools that have not been completely deleted yet (linked via next_garbage) */
+  tGarbageFromDeletedBufferPools* first_pool;
+
+  /*! Link to pool to check next in incremental garbage deletion (points to first_pool or to next_garbage of a pool in list) */
+  tGarbageFromDeletedBufferPools** next_pool;
+
+  /*! Number of pools in list */
+  size_t pool_count;
+
+  tDeletionList() : mutex(), first_pool(nullptr), next_pool(&first_pool), pool_count(0) {}
 
   ~tDeletionList()
   {
-    tGarbageFromDeletedBufferPools::DeleteGarbage();
-    if (garbage_pools.size())
+    tGarbageFromDeletedBufferPools::tCollectionResult result = tGarbageFromDeletedBufferPools::DeleteGarbage();
+    if (result.remaining_pools)
     {
-      RRLIB_LOG_PRINT_STATIC(WARNING, garbage_pools.size(), " buffer pools have not been completely deleted.");
+      RRLIB_LOG_PRINT_STATIC(WARNING, result.remaining_pools, " buffer pools have not been completely deleted.");
     }
   }
 };
@@ -94,27 +110,90 @@ static inline unsigned int GetLongevity(tDeletionList*)
 
 }
 
-void tGarbageFromDeletedBufferPools::AddPool(tGarbageFromDeletedBufferPools* pool)
+tGarbageFromDeletedBufferPools::tGarbageFromDeletedBufferPools() :
+  remaining_buffers(0),
+  next_garbage(nullptr)
 {
-  internal::tDeletionList& list = internal::tDeletionListInstance::Instance();
-  thread::tLock lock(list.mutex);
-  list.garbage_pools.push_back(pool);
+  internal::tDeletionListInstance::Instance(); // create list now (deleting garbage of pools that are not deleted before program exit)
+}
+
+void tGarbageFromDeletedBufferPools::AddPool(tGarbageFromDeletedBufferPools* pool, int remaining_buffers)
+{
+  pool->remaining_buffers = remaining_buffers;
+  tGarbageFromDeletedBufferPools* first = internal::added_pools.load(std::memory_order_relaxed);
+  do
+  {
+    pool->next_garbage = first;
+  }
+  while (!internal::added_pools.compare_exchange_weak(first, pool, std::memory_order_release, std::memory_order_relaxed));
+}
+
+tGarbageFromDeletedBufferPools::tCollectionResult tGarbageFromDeletedBufferPools::DeleteGarbage()
+{
+  return DeleteGarbage(std::numeric_limits<size_t>::max(), std::chrono::nanoseconds::max(), true);
 }
 
-void tGarbageFromDeletedBufferPools::DeleteGarbage()
+tGarbageFromDeletedBufferPools::tCollectionResult tGarbageFromDeletedBufferPools::DeleteGarbage(size_t max_pools, std::chrono::nanoseconds time_budget)
 {
+  return DeleteGarbage(max_pools, time_budget, false);
+}
+
+tGarbageFromDeletedBufferPools::tCollectionResult tGarbageFromDeletedBufferPools::DeleteGarbage(size_t max_pools, std::chrono::nanoseconds time_budget, bool wait_for_other_threads)
+{
+  auto start = std::chrono::steady_clock::now();
   internal::tDeletionList& list = internal::tDeletionListInstance::Instance();
-  thread::tLock lock(list.mutex);
-  for (auto it = list.garbage_pools.begin(); it != list.garbage_pools.end(); ++it)
+  tCollectionResult result;
+  thread::tLock lock(list.mutex, false);
+  if (wait_for_other_threads)
+  {
+    lock.Lock();
+  }
+  else if (!lock.TryLock())
+  {
+    return result;
+  }
+
+  // move added pools to front of list (does not invalidate next_pool)
+  tGarbageFromDeletedBufferPools* added = internal::added_pools.exchange(nullptr, std::memory_order_acquire);
+  while (added)
   {
-    int remaining = (*it)->DeleteBufferPoolGarbage();
-    if (remaining == 0)
+    tGarbageFromDeletedBufferPools* next = added->next_garbage;
+    added->next_garbage = list.first_pool;
+    list.first_pool = added;
+    list.pool_count++;
+    added = next;
+  }
+
+  for (size_t checked = 0, pool_count = list.pool_count; checked < std::min(max_pools, pool_count); checked++)
+  {
+    if (checked > 0 && std::chrono::steady_clock::now() - start >= time_budget)
+    {
+      break;
+    }
+    if (!(*list.next_pool))
+    {
+      list.next_pool = &list.first_pool;
+    }
+    tGarbageFromDeletedBufferPools* pool = *list.next_pool;
+    int remaining = pool->DeleteBufferPoolGarbage();
+    size_t deleted_buffers = static_cast<size_t>(std::max(0, pool->remaining_buffers - remaining));
+    pool->remaining_buffers = remaining;
+    result.reclaimed_buffers += deleted_buffers;
+    result.reclaimed_bytes += deleted_buffers * pool->GetBufferSize();
+    if (remaining <= 0)
+    {
+      *list.next_pool = pool->next_garbage;
+      list.pool_count--;
+      delete pool;
+      result.reclaimed_pools++;
+    }
+    else
     {
-      delete *it;
-      it = list.garbage_pools.erase(it);
-      --it;
+      list.next_pool = &pool->next_garbage;
     }
   }
+  result.remaining_pools = list.pool_count;
+  return result;
 }
 
 //----------------------------------------------------------------------
@@ -40,6 +40,9 @@
 //----------------------------------------------------------------------
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
@@ -62,6 +65,21 @@ template <typename TBufferManagementPolicy>
 class CollectGarbage;
 }
 
+/*!
+ * Size hook for reporting reclaimed memory (see tGarbageFromDeletedBufferPools::tCollectionResult).
+ * Defaults to sizeof(T). Buffer types that own further memory (e.g. payload of fixed size)
+ * can specialize this template to report it as well.
+ */
+template <typename T>
+struct tBufferMemorySize
+{
+  /*! \return Memory of a buffer of type T in bytes */
+  static size_t Get()
+  {
+    return sizeof(T);
+  }
+};
+
 //----------------------------------------------------------------------
 // Class declaration
 //----------------------------------------------------------------------
@@ -75,6 +93,9 @@ class CollectGarbage;
  * Calling DeleteGarbage() will check if any pools
  * can be deleted safely now - and possibly do so.
  * Make sure to call this once in a while to prevent memory leaks.
+ *
+ * Instances are nodes of an intrusive list and are allocated together with a pool's management object.
+ * Therefore, adding garbage neither allocates memory nor blocks (it is a single compare-and-swap operation).
  */
 class tGarbageFromDeletedBufferPools
 {
@@ -84,7 +105,25 @@ class tGarbageFromDeletedBufferPools
 //----------------------------------------------------------------------
 public:
 
-  tGarbageFromDeletedBufferPools() {}
+  /*! Result of deleting garbage */
+  struct tCollectionResult
+  {
+    /*! Number of pools that were deleted completely */
+    size_t reclaimed_pools;
+
+    /*! Number of buffers that were deleted */
+    size_t reclaimed_buffers;
+
+    /*! Memory of deleted buffers in bytes (as reported by tBufferMemorySize) */
+    size_t reclaimed_bytes;
+
+    /*! Number of pools that could not be deleted completely yet */
+    size_t remaining_pools;
+
+    tCollectionResult() : reclaimed_pools(0), reclaimed_buffers(0), reclaimed_bytes(0), remaining_pools(0) {}
+  };
+
+  tGarbageFromDeletedBufferPools();
 
   virtual ~tGarbageFromDeletedBufferPools() {}
 
@@ -93,23 +132,51 @@ public:
    */
   virtual int DeleteBufferPoolGarbage() = 0;
 
+  /*!
+   * To be overridden by subclass
+   *
+   * \return Size of a buffer of this pool in bytes (see tBufferMemorySize)
+   */
+  virtual size_t GetBufferSize() const = 0;
+
   /*!
    * Check if any pools or buffers can be deleted safely now - and possibly do so.
+   *
+   * \return Pools, buffers and memory reclaimed
    */
-  static void DeleteGarbage();
+  static tCollectionResult DeleteGarbage();
+
+  /*!
+   * Bounded-time variant of DeleteGarbage() - e.g. for real-time loops.
+   * Checks pools round-robin: subsequent calls continue with the pool after the last one checked.
+   * Returns immediately if another thread is currently deleting garbage.
+   *
+   * \param max_pools Maximum number of pools to check
+   * \param time_budget No further pools are checked after this time has elapsed (checking a single pool is not interrupted)
+   * \return Pools, buffers and memory reclaimed
+   */
+  static tCollectionResult DeleteGarbage(size_t max_pools, std::chrono::nanoseconds time_budget = std::chrono::nanoseconds::max());
 
-//----------------------------------------------------------------------
-// Private fields and methods
-//----------------------------------------------------------------------
 private:
 
   template <typename TBufferManagementPolicy>
   friend class deleting::CollectGarbage;
 
   /*!
+   * Adds pool to garbage (lock-free and without allocating memory)
+   *
    * \param pool Buffer Pool that could not be deleted completely yet
+   * \param remaining_buffers Number of buffers of pool that have not been returned yet
    */
-  static void AddPool(tGarbageFromDeletedBufferPools* pool);
+  static void AddPool(tGarbageFromDeletedBufferPools* pool, int remaining_buffers);
+
+  /*! Number of buffers that had not been returned when pool was checked last */
+  int remaining_buffers;
+
+  /*! Next pool in list of garbage */
+  tGarbageFromDeletedBufferPools* next_garbage;
+
+  static tCollectionResult DeleteGarbage(size_t max_pools, std::chrono::nanoseconds time_budget, bool wait_for_other_threads);
 
 };
 
@@ -0,0 +1,362 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tGrowingBufferPool.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tGrowingBufferPool
+ *
+ * \b tGrowingBufferPool
+ *
+ * Buffer pool that creates new buffers with a factory when it runs out of unused buffers
+ * - up to a maximum number of buffers.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tGrowingBufferPool_h__
+#define __rrlib__buffer_pools__tGrowingBufferPool_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tBufferPool.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Buffer pool that grows on demand
+/*!
+ * Buffer pool that creates and adds a new buffer when GetUnusedBuffer() finds
+ * no unused buffer - as long as the pool contains less than the specified maximum number of buffers.
+ * This avoids duplicating the "allocate, AddBuffer, use" fallback at every call site.
+ *
+ * Capacity is reserved atomically before a buffer is created.
+ * Therefore, concurrent threads never grow the pool beyond its maximum number of buffers.
+ *
+ * Growth involves memory allocation. For real-time code, the pool should be populated
+ * sufficiently in advance (e.g. using Reserve()) - GetGrowthCount() helps to find suitable sizes.
+ *
+ * The underlying buffer pool is a private base class: only operations that keep the buffer count consistent
+ * with the maximum number of buffers are available (e.g. buffers cannot be added via AddSlabBuffers()).
+ *
+ * TBufferPool  Type of underlying buffer pool (tBufferPool<...>)
+ * TFactory     Type of function object that creates new buffers (returns std::unique_ptr<tManagedType>)
+ */
+template <typename TBufferPool, typename TFactory = std::function<std::unique_ptr<typename TBufferPool::tManagedType>()>>
+class tGrowingBufferPool : private TBufferPool
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  using typename TBufferPool::tBufferManagement;
+  using typename TBufferPool::tRecycler;
+  using typename TBufferPool::tPointer;
+  using typename TBufferPool::tManagedType;
+
+  using TBufferPool::DumpOutstandingBuffers;
+  using TBufferPool::GetStatistics;
+  using TBufferPool::GetUnusedBufferCount;
+  using TBufferPool::RecycleBuffers;
+
+  /*!
+   * \param factory Function object that creates new buffers. May be called from multiple threads concurrently.
+   * \param max_buffers Maximum number of buffers in pool
+   */
+  tGrowingBufferPool(TFactory factory, size_t max_buffers) :
+    factory(factory),
+    max_buffers(max_buffers),
+    buffer_count(0),
+    growth_count(0)
+  {}
+
+  /*!
+   * Add new buffer to pool (counts towards maximum number of buffers - even if it is exceeded).
+   *
+   * \param buffer Buffer to add. unique_ptr is empty after call.
+   * \return Buffer reference. May be used as unused buffer reference immediately (otherwise its automatically recycled by tPointer)
+   */
+  tPointer AddBuffer(std::unique_ptr<tManagedType> && buffer)
+  {
+    buffer_count.fetch_add(1);
+    return TBufferPool::AddBuffer(std::forward<std::unique_ptr<tManagedType>>(buffer));
+  }
+
+  /*!
+   * \return Number of buffers in pool
+   */
+  size_t GetBufferCount() const
+  {
+    return buffer_count.load(std::memory_order_relaxed);
+  }
+
+  /*!
+   * \return How often GetUnusedBuffer() or GetUnusedBuffers() had to create new buffers
+   */
+  size_t GetGrowthCount() const
+  {
+    return growth_count.load(std::memory_order_relaxed);
+  }
+
+  /*!
+   * \return Maximum number of buffers in pool
+   */
+  size_t GetMaxBuffers() const
+  {
+    return max_buffers;
+  }
+
+  /*!
+   * Removes unused buffers from pool until it contains the specified number of buffers (see tBufferPool::ShrinkTo)
+   *
+   * \param target_buffer_count Number of buffers that pool should contain after call
+   * \return Number of buffers removed
+   */
+  size_t ShrinkTo(size_t target_buffer_count)
+  {
+    size_t buffer_count = GetBufferCount();
+    return buffer_count > target_buffer_count ? RemoveUnusedBuffers(buffer_count - target_buffer_count) : 0;
+  }
+
+  /*!
+   * Obtain pointer to unused buffer in pool.
+   * If there is no unused buffer, a new one is created - unless pool has reached its maximum number of buffers.
+   *
+   * \return Unused Buffer - Null if there is no unused buffer in pool and pool cannot grow
+   * \throw Any exception thrown by factory
+   */
+  tPointer GetUnusedBuffer()
+  {
+    tPointer buffer = TBufferPool::GetUnusedBuffer();
+    if ((!buffer) && ReserveBufferCount(1))
+    {
+      growth_count.fetch_add(1, std::memory_order_relaxed);
+      buffer = CreateBuffer();
+    }
+    return buffer;
+  }
+
+  /*!
+   * Obtain pointer to unused buffer in pool.
+   * If there is no unused buffer and pool cannot grow, waits until one is recycled - or the timeout expires
+   * (see tBufferPool::GetUnusedBuffer(timeout)).
+   *
+   * \param timeout Maximum time to wait
+   * \return Unused Buffer - Null if no buffer became available before timeout
+   * \throw Any exception thrown by factory
+   */
+  template <typename TRep, typename TPeriod>
+  tPointer GetUnusedBuffer(const std::chrono::duration<TRep, TPeriod>& timeout)
+  {
+    return GetUnusedBufferUntil(std::chrono::steady_clock::now() + timeout);
+  }
+
+  /*!
+   * Obtain pointer to unused buffer in pool.
+   * If there is no unused buffer and pool cannot grow, waits until one is recycled - or the deadline is reached
+   * (see tBufferPool::GetUnusedBufferUntil(deadline)).
+   *
+   * \param deadline Time point at which to stop waiting
+   * \return Unused Buffer - Null if no buffer became available before deadline
+   * \throw Any exception thrown by factory
+   */
+  template <typename TClock, typename TDuration>
+  tPointer GetUnusedBufferUntil(const std::chrono::time_point<TClock, TDuration>& deadline)
+  {
+    tPointer buffer = GetUnusedBuffer();
+    return buffer ? std::move(buffer) : TBufferPool::GetUnusedBufferUntil(deadline);
+  }
+
+  /*!
+   * Obtain multiple unused buffers from pool in one operation.
+   * If there are not enough unused buffers, new ones are created - unless pool has reached its maximum number of buffers.
+   *
+   * \param begin Begin of output range of tPointer objects to store buffers in
+   * \param end End of output range. Up to (end - begin) buffers are obtained.
+   * \param all_or_nothing If true, no buffers are obtained if pool cannot provide enough buffers.
+   * \return Number of buffers obtained. They are stored at the beginning of the output range.
+   * \throw Any exception thrown by factory
+   */
+  template <typename TIterator>
+  size_t GetUnusedBuffers(TIterator begin, TIterator end, bool all_or_nothing = false)
+  {
+    size_t count = std::distance(begin, end);
+    size_t obtained = TBufferPool::GetUnusedBuffers(begin, end);
+    size_t missing = ReserveBufferCount(count - obtained);
+    if (all_or_nothing && obtained + missing < count)
+    {
+      buffer_count.fetch_sub(missing);
+      for (; obtained > 0; obtained--, ++begin)
+      {
+        begin->reset();
+      }
+      return 0;
+    }
+    if (missing)
+    {
+      growth_count.fetch_add(1, std::memory_order_relaxed);
+      TIterator output = begin;
+      std::advance(output, obtained);
+      for (; missing > 0; missing--, obtained++, ++output)
+      {
+        try
+        {
+          *output = CreateBuffer();
+        }
+        catch (...)
+        {
+          buffer_count.fetch_sub(missing - 1);
+          throw;
+        }
+      }
+    }
+    return obtained;
+  }
+
+  /*!
+   * Removes unused buffers from pool and deletes them (see tBufferPool::RemoveUnusedBuffers)
+   *
+   * \param count Maximum number of buffers to remove
+   * \return Number of buffers removed
+   */
+  size_t RemoveUnusedBuffers(size_t count)
+  {
+    size_t removed = TBufferPool::RemoveUnusedBuffers(count);
+    buffer_count.fetch_sub(removed);
+    return removed;
+  }
+
+  /*!
+   * Adds new buffers created by factory to pool (up to maximum number of buffers)
+   *
+   * \param count Number of buffers to add
+   * \param construction_threads Number of threads to construct buffers with (see tBufferPool::Reserve)
+   * \return Number of buffers added
+   * \throw Any exception thrown by factory (no buffers are added in this case)
+   */
+  size_t Reserve(size_t count, unsigned int construction_threads = 1)
+  {
+    count = ReserveBufferCount(count);
+    try
+    {
+      TBufferPool::Reserve(count, factory, construction_threads);
+    }
+    catch (...)
+    {
+      buffer_count.fetch_sub(count);
+      throw;
+    }
+    return count;
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Function object that creates new buffers */
+  TFactory factory;
+
+  /*! Maximum number of buffers in pool */
+  const size_t max_buffers;
+
+  /*! Number of buffers in pool (including buffers whose creation is in progress) */
+  std::atomic<size_t> buffer_count;
+
+  /*! How often pool had to create new buffers on demand */
+  std::atomic<size_t> growth_count;
+
+
+  /*!
+   * Creates new buffer and adds it to pool.
+   * Capacity must have been reserved with ReserveBufferCount() before.
+   *
+   * \return New buffer (in use)
+   */
+  tPointer CreateBuffer()
+  {
+    try
+    {
+      return TBufferPool::AddBuffer(factory());
+    }
+    catch (...)
+    {
+      buffer_count.fetch_sub(1);
+      throw;
+    }
+  }
+
+  /*!
+   * Atomically increases buffer count - as far as this does not exceed maximum number of buffers
+   *
+   * \param count Number of buffers to add
+   * \return Number of buffers that buffer count was increased by (count or less)
+   */
+  size_t ReserveBufferCount(size_t count)
+  {
+    size_t current_count = buffer_count.load();
+    size_t reserved = 0;
+    do
+    {
+      reserved = current_count < max_buffers ? std::min(count, max_buffers - current_count) : 0;
+      if (reserved == 0)
+      {
+        return 0;
+      }
+    }
+    while (!buffer_count.compare_exchange_weak(current_count, current_count + reserved));
+    return reserved;
+  }
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
@@ -0,0 +1,115 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tHandleBuffer.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tHandleBuffer
+ *
+ * \b tHandleBuffer
+ *
+ * Types that are subclasses of this, can be used with the UseCompactHandles recycling policy.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tHandleBuffer_h__
+#define __rrlib__buffer_pools__tHandleBuffer_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tBufferHandle.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+namespace recycling
+{
+template <typename TBufferManagement>
+class HandleTableManagement;
+
+template <typename T, typename TBufferManagementPolicy>
+class UseCompactHandles;
+}
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Super class for buffers that can be referenced by compact handles
+/*!
+ * Types that are subclasses of this, can be used with the UseCompactHandles recycling policy.
+ * Stores the buffer's slot in the handle table of its pool (pool id and slot index).
+ */
+class tHandleBuffer
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  tHandleBuffer() : handle_slot() {}
+
+  tHandleBuffer(const tHandleBuffer&) : handle_slot() {}
+
+  tHandleBuffer& operator=(const tHandleBuffer&)
+  {
+    return *this; // slot belongs to object - not to its content
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  template <typename TBufferManagement>
+  friend class recycling::HandleTableManagement;
+
+  template <typename T, typename TBufferManagementPolicy>
+  friend class recycling::UseCompactHandles;
+
+  /*! Pool id and slot index of buffer in handle table (generation is zero) */
+  tBufferHandle handle_slot;
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
@@ -0,0 +1,166 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tIdleBufferTrimmer.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tIdleBufferTrimmer
+ *
+ * \b tIdleBufferTrimmer
+ *
+ * Removes buffers from a pool that stayed idle above a high-water mark for some time.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tIdleBufferTrimmer_h__
+#define __rrlib__buffer_pools__tIdleBufferTrimmer_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/util/tNoncopyable.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Trims idle buffers from buffer pool
+/*!
+ * Releases buffers of a pool that stayed idle for a configurable time
+ * while the pool contained more buffers than a high-water mark.
+ * This way, pools return memory after load spikes - without shrinking
+ * below the size that is needed during normal operation.
+ *
+ * Trim() needs to be called periodically (considerably more often than the idle time)
+ * - e.g. from a maintenance thread. It samples how many buffers above the high-water mark
+ * are unused (via GetUnusedBufferCount() - without obtaining any buffers from the pool).
+ * Buffers that were unused in all samples of an idle time interval are removed.
+ *
+ * TBufferPool  Type of buffer pool (tBufferPool<...> or tGrowingBufferPool<...>)
+ */
+template <typename TBufferPool>
+class tIdleBufferTrimmer : private util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*!
+   * \param pool Buffer pool to trim (must exist as long as this object)
+   * \param high_water_mark Pool is never trimmed below this number of buffers
+   * \param idle_time Time that buffers need to stay idle before they are removed
+   */
+  tIdleBufferTrimmer(TBufferPool& pool, size_t high_water_mark, std::chrono::steady_clock::duration idle_time) :
+    pool(pool),
+    high_water_mark(high_water_mark),
+    idle_time(idle_time),
+    interval_start(std::chrono::steady_clock::now()),
+    minimum_idle_buffers(std::numeric_limits<size_t>::max())
+  {}
+
+  /*!
+   * Samples idle buffers and removes buffers that stayed idle during the last idle time interval.
+   * Must not be called concurrently.
+   *
+   * \return Number of buffers removed
+   */
+  size_t Trim()
+  {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    size_t buffer_count = pool.GetBufferCount();
+    size_t excess_buffers = buffer_count > high_water_mark ? buffer_count - high_water_mark : 0;
+    if (excess_buffers == 0)
+    {
+      StartInterval(now);
+      return 0;
+    }
+
+    size_t idle_buffers = std::min(pool.GetUnusedBufferCount(), excess_buffers);
+    minimum_idle_buffers = std::min(minimum_idle_buffers, idle_buffers);
+
+    if (now - interval_start < idle_time)
+    {
+      return 0;
+    }
+    size_t removed = minimum_idle_buffers ? pool.RemoveUnusedBuffers(minimum_idle_buffers) : 0;
+    StartInterval(now);
+    return removed;
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Buffer pool to trim */
+  TBufferPool& pool;
+
+  /*! Pool is never trimmed below this number of buffers */
+  const size_t high_water_mark;
+
+  /*! Time that buffers need to stay idle before they are removed */
+  const std::chrono::steady_clock::duration idle_time;
+
+  /*! Start of current idle time interval */
+  std::chrono::steady_clock::time_point interval_start;
+
+  /*! Minimum number of idle buffers above high-water mark sampled in current interval */
+  size_t minimum_idle_buffers;
+
+
+  void StartInterval(std::chrono::steady_clock::time_point now)
+  {
+    interval_start = now;
+    minimum_idle_buffers = std::numeric_limits<size_t>::max();
+  }
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
@@ -0,0 +1,147 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tRecyclingBatch.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tRecyclingBatch
+ *
+ * \b tRecyclingBatch
+ *
+ * Collects buffers to recycle and returns them to their pools together.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tRecyclingBatch_h__
+#define __rrlib__buffer_pools__tRecyclingBatch_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/util/tNoncopyable.h"
+#include <array>
+#include <utility>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tBufferManagementInfo.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Batch of buffers to recycle
+/*!
+ * Collects buffers to recycle and returns them to their pools together
+ * when the batch is full, when Flush() is called, or when the batch goes out of scope.
+ * Depending on the buffer management policy, this requires considerably fewer
+ * contended atomic operations than recycling buffers one at a time.
+ *
+ * Typical use: a stage that releases a frame's worth of buffers at the end of a cycle
+ * moves all its tPointer objects into a tRecyclingBatch object on the stack.
+ *
+ * TBufferPool  Type of buffer pool (tBufferPool<...>) that buffers originate from (buffers may originate from different pools of this type)
+ * CAPACITY     Maximum number of buffers collected before batch is flushed
+ */
+template <typename TBufferPool, size_t CAPACITY = 32>
+class tRecyclingBatch : private util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  tRecyclingBatch() : buffers(), count(0)
+  {}
+
+  ~tRecyclingBatch()
+  {
+    Flush();
+  }
+
+  /*!
+   * Adds buffer to batch
+   *
+   * \param buffer Buffer to recycle. Pointer is empty after call. Empty pointers are ignored.
+   */
+  void Add(typename TBufferPool::tPointer && buffer)
+  {
+    if (!buffer)
+    {
+      return;
+    }
+    buffers[count] = TBufferPool::tRecycler::ReleaseBuffer(buffer);
+    count++;
+    if (count == CAPACITY)
+    {
+      Flush();
+    }
+  }
+
+  /*!
+   * Recycles all buffers collected so far
+   */
+  void Flush()
+  {
+    if (count)
+    {
+      TBufferPool::tBufferManagement::RecycleBuffers(buffers.data(), count);
+      count = 0;
+    }
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Buffers collected for recycling */
+  std::array<std::pair<tBufferManagementInfo, typename TBufferPool::tManagedType*>, CAPACITY> buffers;
+
+  /*! Number of buffers collected */
+  size_t count;
+
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
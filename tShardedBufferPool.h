@@ -0,0 +1,343 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tShardedBufferPool.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tShardedBufferPool
+ *
+ * \b tShardedBufferPool
+ *
+ * Buffer pool that consists of one sub-pool per CPU (or thread group).
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tShardedBufferPool_h__
+#define __rrlib__buffer_pools__tShardedBufferPool_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/util/tNoncopyable.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <sched.h>
+#include <thread>
+#include <type_traits>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tBufferPool.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+/*! Determines which shard a thread uses */
+enum class tShardSelection
+{
+  CPU,    //!< Shard of CPU that thread is currently running on (via sched_getcpu)
+  THREAD  //!< Fixed shard per thread (threads are assigned to shards round-robin)
+};
+
+/*! Determines which shard buffers are recycled to */
+enum class tShardRecycling
+{
+  HOME_SHARD,    //!< Shard that buffer was added to
+  CURRENT_SHARD  //!< Shard of recycling thread (buffer is transferred; requires management policy with AdoptBuffer() - e.g. QueueBased or StackBased).
+                 //!< As the sharded pool selects the shard, all buffers must be returned before it is deleted.
+};
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Sharded buffer pool
+/*!
+ * Buffer pool that consists of one sub-pool (shard) per CPU - or per group of threads.
+ * Threads obtain buffers from their local shard. Only if it is empty, they steal
+ * from other shards: up to two randomly chosen shards are tried first (in random order -
+ * without comparing how many unused buffers they contain), then all remaining shards.
+ * Random probing spreads stealing threads across shards.
+ * With many threads, this avoids contention and cache-line transfers on a single
+ * queue or chunk array.
+ *
+ * With tShardRecycling::CURRENT_SHARD, buffers refer to the sharded pool until they are returned.
+ * So all of them must be returned before the sharded pool is deleted - regardless of the shards'
+ * deleting policy (this is checked by an assertion in the destructor).
+ * With tShardRecycling::HOME_SHARD, buffers only refer to their shard - and the shards'
+ * deleting policy applies (e.g. CollectGarbage or DeleteOnLastReturn).
+ *
+ * TBufferPool  Type of shards (tBufferPool<...> with tConcurrency::FULL)
+ * RECYCLING    Shard that buffers are recycled to
+ */
+template <typename TBufferPool, tShardRecycling RECYCLING = tShardRecycling::HOME_SHARD>
+class tShardedBufferPool : private util::tNoncopyable
+{
+  /*! Recycler that returns buffers to the shard of the recycling thread */
+  class tCurrentShardRecycler
+  {
+  public:
+    tCurrentShardRecycler() : pool(NULL), recycler() {}
+    tCurrentShardRecycler(tShardedBufferPool* pool, const typename TBufferPool::tRecycler& recycler) : pool(pool), recycler(recycler) {}
+
+    void operator()(typename TBufferPool::tPointer::element_type* buffer) const
+    {
+      typename TBufferPool::tPointer pointer(buffer, recycler);
+      std::pair<tBufferManagementInfo, typename TBufferPool::tManagedType*> released = TBufferPool::tRecycler::ReleaseBuffer(pointer);
+      size_t shard_index = pool->GetCurrentShardIndex();
+      pool->shards[shard_index].InternalBufferManagement().AdoptBuffer(released.second, released.first);
+      UpdateInfoInBuffer(released.second, released.first);
+      TBufferPool::tBufferManagement::RecycleBuffer(released.first, released.second);
+      pool->outstanding_buffers[shard_index].count.fetch_sub(1, std::memory_order_relaxed); // last access to pool
+    }
+
+  private:
+    tShardedBufferPool* pool;
+    typename TBufferPool::tRecycler recycler;
+
+    static void UpdateInfoInBuffer(tBufferManagementInfo* buffer, const tBufferManagementInfo& info)
+    {
+      *buffer = info; // e.g. UseOwnerStorageInBuffer reads owner from buffer
+    }
+    static void UpdateInfoInBuffer(void*, const tBufferManagementInfo&) {}
+  };
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  typedef typename TBufferPool::tManagedType tManagedType;
+
+  typedef typename std::conditional < RECYCLING == tShardRecycling::HOME_SHARD, typename TBufferPool::tPointer,
+          std::unique_ptr<typename TBufferPool::tPointer::element_type, tCurrentShardRecycler >>::type tPointer;
+
+  /*!
+   * \param shard_count Number of shards (typically number of CPUs)
+   * \param selection Determines which shard a thread uses
+   */
+  tShardedBufferPool(size_t shard_count = std::max(1u, std::thread::hardware_concurrency()), tShardSelection selection = tShardSelection::CPU) :
+    shard_count(std::max<size_t>(1, shard_count)),
+    selection(selection),
+    outstanding_buffers(RECYCLING == tShardRecycling::CURRENT_SHARD ? new tOutstandingBufferCounter[this->shard_count] : NULL),
+    shards(new TBufferPool[this->shard_count])
+  {}
+
+  ~tShardedBufferPool()
+  {
+    assert(GetOutstandingBufferCount() == 0 && "With tShardRecycling::CURRENT_SHARD, all buffers must be returned before pool is deleted");
+  }
+
+  /*!
+   * Add new buffer to shard of calling thread
+   *
+   * \param buffer Buffer to add. unique_ptr is empty after call.
+   * \return Buffer reference. May be used as unused buffer reference immediately (otherwise its automatically recycled by tPointer)
+   */
+  tPointer AddBuffer(std::unique_ptr<tManagedType> && buffer)
+  {
+    return Wrap(shards[GetCurrentShardIndex()].AddBuffer(std::forward<std::unique_ptr<tManagedType>>(buffer)));
+  }
+
+  /*!
+   * \return Number of buffers obtained from this pool that have not been returned yet
+   * (only tracked with tShardRecycling::CURRENT_SHARD - zero otherwise)
+   */
+  size_t GetOutstandingBufferCount() const
+  {
+    ptrdiff_t count = 0;
+    for (size_t i = 0; outstanding_buffers && i < shard_count; i++)
+    {
+      count += outstanding_buffers[i].count.load(std::memory_order_relaxed);
+    }
+    return static_cast<size_t>(std::max<ptrdiff_t>(0, count));
+  }
+
+  /*!
+   * \return Index of shard that calling thread currently uses
+   */
+  size_t GetCurrentShardIndex() const
+  {
+    if (selection == tShardSelection::CPU)
+    {
+      int cpu = sched_getcpu();
+      if (cpu >= 0)
+      {
+        return static_cast<size_t>(cpu) % shard_count;
+      }
+    }
+    static std::atomic<size_t> thread_counter(0);
+    static thread_local size_t thread_index = thread_counter.fetch_add(1, std::memory_order_relaxed);
+    return thread_index % shard_count;
+  }
+
+  /*!
+   * \param index Index of shard
+   * \return Shard with specified index
+   */
+  TBufferPool& GetShard(size_t index)
+  {
+    assert(index < shard_count);
+    return shards[index];
+  }
+
+  /*!
+   * \return Number of shards
+   */
+  size_t GetShardCount() const
+  {
+    return shard_count;
+  }
+
+  /*!
+   * Obtain pointer to unused buffer - from local shard or, if it is empty, from another shard
+   *
+   * \return Unused Buffer - Null if there is no unused buffer in any shard
+   */
+  tPointer GetUnusedBuffer()
+  {
+    size_t local = GetCurrentShardIndex();
+    typename TBufferPool::tPointer buffer = shards[local].GetUnusedBuffer();
+    if (buffer || shard_count == 1)
+    {
+      return Wrap(std::move(buffer));
+    }
+
+    // try two random shards first (spreads stealing threads - shard occupancy is not compared)
+    size_t first_choice = (local + 1 + Random() % (shard_count - 1)) % shard_count;
+    buffer = shards[first_choice].GetUnusedBuffer();
+    size_t second_choice = (local + 1 + Random() % (shard_count - 1)) % shard_count;
+    if ((!buffer) && second_choice != first_choice)
+    {
+      buffer = shards[second_choice].GetUnusedBuffer();
+    }
+
+    for (size_t i = 1; i < shard_count && (!buffer); i++)
+    {
+      size_t index = (local + i) % shard_count;
+      if (index != first_choice && index != second_choice)
+      {
+        buffer = shards[index].GetUnusedBuffer();
+      }
+    }
+    return Wrap(std::move(buffer));
+  }
+
+  /*!
+   * Adds new buffers to pool - distributed evenly among shards (see tBufferPool::Reserve)
+   *
+   * \param count Number of buffers to add
+   * \param factory Function object that returns a new buffer as std::unique_ptr<tManagedType>
+   * \throw Any exception thrown by factory
+   */
+  template <typename TFactory>
+  void Reserve(size_t count, TFactory factory)
+  {
+    for (size_t i = 0; i < shard_count; i++)
+    {
+      shards[i].Reserve(count / shard_count + (i < count % shard_count ? 1 : 0), factory);
+    }
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Counter of buffers in use - one per shard, padded so that adjacent counters are in different cache lines (new[] does not guarantee extended alignment before C++17) */
+  struct tOutstandingBufferCounter
+  {
+    std::atomic<ptrdiff_t> count;
+    char padding[64 - sizeof(std::atomic<ptrdiff_t>)];
+
+    tOutstandingBufferCounter() : count(0), padding() {}
+  };
+
+  /*! Number of shards */
+  const size_t shard_count;
+
+  /*! Determines which shard a thread uses */
+  const tShardSelection selection;
+
+  /*! Number of buffers in use - counted on shard of obtaining and recycling thread (only used with tShardRecycling::CURRENT_SHARD) */
+  std::unique_ptr<tOutstandingBufferCounter[]> outstanding_buffers;
+
+  /*! Shards */
+  std::unique_ptr<TBufferPool[]> shards;
+
+
+  /*!
+   * \return Thread-local pseudo-random number (xorshift)
+   */
+  static size_t Random()
+  {
+    static thread_local uint32_t state = 0x9E3779B9u ^ static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&state));
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+
+  template <typename TPointer = tPointer>
+  typename std::enable_if<std::is_same<TPointer, typename TBufferPool::tPointer>::value, TPointer>::type Wrap(typename TBufferPool::tPointer && pointer)
+  {
+    return std::move(pointer);
+  }
+
+  template <typename TPointer = tPointer>
+  typename std::enable_if < !std::is_same<TPointer, typename TBufferPool::tPointer>::value, TPointer >::type Wrap(typename TBufferPool::tPointer && pointer)
+  {
+    typename TBufferPool::tRecycler recycler = pointer.get_deleter();
+    if (pointer)
+    {
+      outstanding_buffers[GetCurrentShardIndex()].count.fetch_add(1, std::memory_order_relaxed);
+    }
+    return TPointer(pointer.release(), tCurrentShardRecycler(this, recycler));
+  }
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
@@ -0,0 +1,107 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tSharedBuffer.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tSharedBuffer
+ *
+ * \b tSharedBuffer
+ *
+ * Types that are subclasses of this, can be shared via tSharedPointer.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tSharedBuffer_h__
+#define __rrlib__buffer_pools__tSharedBuffer_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <atomic>
+#include <cstddef>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+template <typename TBufferPool>
+class tSharedPointer;
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Super class for buffers that can be shared
+/*!
+ * Types that are subclasses of this, can be shared via tSharedPointer.
+ * Contains the reference counter of tSharedPointer (so that sharing buffers does not require allocating memory).
+ */
+class tSharedBuffer
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  tSharedBuffer() : reference_count(0) {}
+
+  tSharedBuffer(const tSharedBuffer&) : reference_count(0) {}
+
+  tSharedBuffer& operator=(const tSharedBuffer&)
+  {
+    return *this; // reference counter belongs to object - not to its content
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  template <typename TBufferPool>
+  friend class tSharedPointer;
+
+  /*! Number of tSharedPointer objects that refer to this buffer */
+  std::atomic<size_t> reference_count;
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
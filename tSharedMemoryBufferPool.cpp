@@ -0,0 +1,449 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tSharedMemoryBufferPool.cpp
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ */
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tSharedMemoryBufferPool.h"
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <atomic>
+#include <cerrno>
+#include <fcntl.h>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "Atomics in shared memory must be lock-free (and therefore address-free)");
+
+/*! Header at the beginning of every segment (all locations are offsets) */
+struct tSharedMemoryBufferPool::tSegmentHeader
+{
+  /*! Identifies initialized segment (written last) */
+  std::atomic<uint64_t> magic;
+
+  /*! Version of segment layout */
+  uint32_t version;
+
+  /*! Number of buffers */
+  uint32_t buffer_count;
+
+  /*! Size of every buffer and distance between buffers in bytes */
+  uint64_t buffer_size, buffer_stride;
+
+  /*! Offsets of buffer states and first buffer */
+  uint64_t states_offset, buffers_offset;
+
+  /*! Size of segment */
+  uint64_t segment_size;
+
+  /*! Index where search for unused buffers starts (next fit) */
+  alignas(64) std::atomic<uint32_t> scan_start_index;
+};
+
+/*!
+ * State of buffer: Owner attachment id (upper 32 bits, 0 if unused), generation (31 bits) and 'in transit' flag (lowest bit).
+ * Every state is placed in a cache line of its own.
+ */
+struct alignas(64) tSharedMemoryBufferPool::tBufferState
+{
+  std::atomic<uint64_t> state;
+};
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+namespace
+{
+
+const uint64_t cMAGIC = 0x72726c6962627370ull; // "rrlibbsp"
+const uint32_t cVERSION = 2;
+const size_t cCACHE_LINE_SIZE = 64;
+const uint32_t cMAX_GENERATION = 0x7FFFFFFF;
+const uint32_t cMAX_ATTACHMENTS = 4096;
+
+inline size_t AlignUp(size_t value, size_t alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+inline uint64_t MakeState(uint32_t owner, uint32_t generation, bool in_transit)
+{
+  return (static_cast<uint64_t>(owner) << 32) | (static_cast<uint64_t>(generation) << 1) | (in_transit ? 1 : 0);
+}
+
+inline uint32_t GetOwner(uint64_t state)
+{
+  return static_cast<uint32_t>(state >> 32);
+}
+
+inline uint32_t GetGeneration(uint64_t state)
+{
+  return static_cast<uint32_t>(state >> 1) & cMAX_GENERATION;
+}
+
+inline bool IsInTransit(uint64_t state)
+{
+  return state & 1;
+}
+
+inline uint32_t NextGeneration(uint32_t generation)
+{
+  return generation == cMAX_GENERATION ? 1 : generation + 1;
+}
+
+/*!
+ * Performs fcntl operation on lock of attachment (byte at offset attachment_id in segment file)
+ */
+int LockAttachment(int file_descriptor, int command, struct flock& lock, uint32_t attachment_id)
+{
+  lock = flock();
+  lock.l_type = F_WRLCK;
+  lock.l_whence = SEEK_SET;
+  lock.l_start = attachment_id;
+  lock.l_len = 1;
+  lock.l_pid = 0; // required for open file description locks
+  return fcntl(file_descriptor, command, &lock);
+}
+
+}
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+
+tSharedMemoryBufferPool::tSharedMemoryBufferPool() :
+  file_descriptor(-1),
+  segment(NULL),
+  segment_size(0),
+  header(NULL),
+  states(NULL),
+  buffers(NULL),
+  buffer_size(0),
+  buffer_stride(0),
+  buffer_count(0),
+  attachment_id(0)
+{}
+
+tSharedMemoryBufferPool::tSharedMemoryBufferPool(const std::string& name, size_t buffer_size, uint32_t buffer_count) :
+  tSharedMemoryBufferPool()
+{
+  file_descriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (file_descriptor < 0)
+  {
+    throw std::system_error(errno, std::system_category(), "Could not create shared memory segment " + name);
+  }
+  try
+  {
+    Initialize(buffer_size, buffer_count);
+  }
+  catch (...)
+  {
+    shm_unlink(name.c_str());
+    throw;
+  }
+}
+
+tSharedMemoryBufferPool::tSharedMemoryBufferPool(size_t buffer_size, uint32_t buffer_count) :
+  tSharedMemoryBufferPool()
+{
+  file_descriptor = memfd_create("rrlib_buffer_pool", MFD_CLOEXEC);
+  if (file_descriptor < 0)
+  {
+    throw std::system_error(errno, std::system_category(), "Could not create anonymous shared memory segment");
+  }
+  Initialize(buffer_size, buffer_count);
+}
+
+tSharedMemoryBufferPool::tSharedMemoryBufferPool(const std::string& name) :
+  tSharedMemoryBufferPool()
+{
+  file_descriptor = shm_open(name.c_str(), O_RDWR, 0);
+  if (file_descriptor < 0)
+  {
+    throw std::system_error(errno, std::system_category(), "Could not open shared memory segment " + name);
+  }
+  Open();
+}
+
+tSharedMemoryBufferPool::tSharedMemoryBufferPool(int file_descriptor) :
+  tSharedMemoryBufferPool()
+{
+  // Reopen instead of duplicating descriptor: locks of attachments must be held by an open file description of their own
+  this->file_descriptor = open(("/proc/self/fd/" + std::to_string(file_descriptor)).c_str(), O_RDWR | O_CLOEXEC);
+  if (this->file_descriptor < 0)
+  {
+    throw std::system_error(errno, std::system_category(), "Could not reopen shared memory segment");
+  }
+  Open();
+}
+
+tSharedMemoryBufferPool::~tSharedMemoryBufferPool()
+{
+  if (segment)
+  {
+    munmap(segment, segment_size);
+  }
+  if (file_descriptor >= 0)
+  {
+    close(file_descriptor);
+  }
+}
+
+tSharedMemoryBufferPool::tPointer tSharedMemoryBufferPool::GetUnusedBuffer()
+{
+  uint32_t start_index = header->scan_start_index.load(std::memory_order_relaxed);
+  start_index = start_index < buffer_count ? start_index : 0;
+  for (uint32_t i = 0, index = start_index; i < buffer_count; i++, index = (index + 1 == buffer_count) ? 0 : index + 1)
+  {
+    uint64_t state = states[index].state.load(std::memory_order_relaxed);
+    if (GetOwner(state) == 0 &&
+        states[index].state.compare_exchange_strong(state, MakeState(attachment_id, GetGeneration(state), false), std::memory_order_acquire, std::memory_order_relaxed))
+    {
+      header->scan_start_index.store(index + 1, std::memory_order_relaxed);
+      return tPointer(buffers + index * buffer_stride, tRecycler(this));
+    }
+  }
+  return tPointer();
+}
+
+void tSharedMemoryBufferPool::Initialize(size_t buffer_size, uint32_t buffer_count)
+{
+  if (buffer_size == 0 || buffer_count == 0)
+  {
+    throw std::invalid_argument("Shared memory buffer pool requires buffers with non-zero size");
+  }
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t states_offset = AlignUp(sizeof(tSegmentHeader), cCACHE_LINE_SIZE);
+  size_t buffers_offset = AlignUp(states_offset + buffer_count * sizeof(tBufferState), page_size);
+  size_t buffer_stride = AlignUp(buffer_size, cCACHE_LINE_SIZE);
+  size_t size = AlignUp(buffers_offset + buffer_count * buffer_stride, page_size);
+  if (ftruncate(file_descriptor, size))
+  {
+    throw std::system_error(errno, std::system_category(), "Could not resize shared memory segment");
+  }
+  Map(size);
+
+  header = new(segment) tSegmentHeader();
+  header->version = cVERSION;
+  header->buffer_count = buffer_count;
+  header->buffer_size = buffer_size;
+  header->buffer_stride = buffer_stride;
+  header->states_offset = states_offset;
+  header->buffers_offset = buffers_offset;
+  header->segment_size = size;
+  header->scan_start_index.store(0, std::memory_order_relaxed);
+  tBufferState* states = reinterpret_cast<tBufferState*>(static_cast<char*>(segment) + states_offset);
+  for (uint32_t i = 0; i < buffer_count; i++)
+  {
+    new(&states[i]) tBufferState();
+    states[i].state.store(MakeState(0, 1, false), std::memory_order_relaxed);
+  }
+  header->magic.store(cMAGIC, std::memory_order_release); // pool may be used by other processes from now on
+  Open();
+}
+
+void tSharedMemoryBufferPool::Map(size_t size)
+{
+  if (segment)
+  {
+    munmap(segment, segment_size);
+    segment = NULL;
+  }
+  void* address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+  if (address == MAP_FAILED)
+  {
+    throw std::system_error(errno, std::system_category(), "Could not map shared memory segment");
+  }
+  segment = address;
+  segment_size = size;
+}
+
+void tSharedMemoryBufferPool::Open()
+{
+  struct stat status;
+  if (fstat(file_descriptor, &status))
+  {
+    throw std::system_error(errno, std::system_category(), "Could not determine size of shared memory segment");
+  }
+  size_t size = static_cast<size_t>(status.st_size);
+  if (size < sizeof(tSegmentHeader))
+  {
+    throw std::runtime_error("Shared memory segment does not contain a buffer pool");
+  }
+  if (segment_size != size)
+  {
+    Map(size);
+  }
+  header = static_cast<tSegmentHeader*>(segment);
+  if (header->magic.load(std::memory_order_acquire) != cMAGIC || header->version != cVERSION ||
+      header->segment_size > size || header->buffers_offset + header->buffer_count * header->buffer_stride > header->segment_size ||
+      header->states_offset + header->buffer_count * sizeof(tBufferState) > header->buffers_offset)
+  {
+    throw std::runtime_error("Shared memory segment does not contain an initialized buffer pool");
+  }
+  states = reinterpret_cast<tBufferState*>(static_cast<char*>(segment) + header->states_offset);
+  buffers = static_cast<uint8_t*>(segment) + header->buffers_offset;
+  buffer_size = header->buffer_size;
+  buffer_stride = header->buffer_stride;
+  buffer_count = header->buffer_count;
+  Attach();
+}
+
+tSharedMemoryBufferPool::tTransferHandle tSharedMemoryBufferPool::Pass(tPointer && buffer)
+{
+  tTransferHandle handle = { 0, 0 };
+  if (buffer)
+  {
+    handle.index = GetIndex(buffer.release());
+    uint64_t state = states[handle.index].state.load(std::memory_order_relaxed);
+    handle.generation = GetGeneration(state);
+    states[handle.index].state.store(MakeState(attachment_id, handle.generation, true), std::memory_order_release);
+  }
+  return handle;
+}
+
+tSharedMemoryBufferPool::tPointer tSharedMemoryBufferPool::Receive(const tTransferHandle& handle)
+{
+  if (handle.generation && handle.index < buffer_count)
+  {
+    uint64_t state = states[handle.index].state.load(std::memory_order_relaxed);
+    if (IsInTransit(state) && GetGeneration(state) == handle.generation &&
+        states[handle.index].state.compare_exchange_strong(state, MakeState(attachment_id, handle.generation, false), std::memory_order_acquire, std::memory_order_relaxed))
+    {
+      return tPointer(buffers + handle.index * buffer_stride, tRecycler(this));
+    }
+  }
+  return tPointer();
+}
+
+void tSharedMemoryBufferPool::RecycleBuffer(uint8_t* buffer)
+{
+  tBufferState& buffer_state = states[GetIndex(buffer)];
+  uint64_t state = buffer_state.state.load(std::memory_order_relaxed);
+  assert(GetOwner(state) == attachment_id && (!IsInTransit(state)));
+  buffer_state.state.store(MakeState(0, NextGeneration(GetGeneration(state)), false), std::memory_order_release);
+}
+
+size_t tSharedMemoryBufferPool::RecoverBuffers()
+{
+  size_t recovered = 0;
+  for (uint32_t i = 0; i < buffer_count; i++)
+  {
+    // Attachment id is checked after loading state (results must not be cached, as other objects may attach with a free id meanwhile):
+    // If another object attaches with the id later, its Attach() changes the generation of this state - so that compare-and-swap fails
+    uint64_t state = states[i].state.load(std::memory_order_acquire);
+    uint32_t owner = GetOwner(state);
+    if (owner && owner != attachment_id && owner <= cMAX_ATTACHMENTS)
+    {
+      if ((!IsAttached(owner)) && states[i].state.compare_exchange_strong(state, MakeState(0, NextGeneration(GetGeneration(state)), false)))
+      {
+        recovered++;
+      }
+    }
+  }
+  return recovered;
+}
+
+void tSharedMemoryBufferPool::Attach()
+{
+  struct flock lock;
+  for (uint32_t id = 1; id <= cMAX_ATTACHMENTS; id++)
+  {
+    if (LockAttachment(file_descriptor, F_OFD_SETLK, lock, id) == 0)
+    {
+      attachment_id = id;
+
+      // Buffers of previous object with this id are still marked as owned by this id
+      for (uint32_t i = 0; i < buffer_count; i++)
+      {
+        uint64_t state = states[i].state.load(std::memory_order_acquire);
+        if (GetOwner(state) == id)
+        {
+          states[i].state.compare_exchange_strong(state, MakeState(0, NextGeneration(GetGeneration(state)), false));
+        }
+      }
+      return;
+    }
+    if (errno != EAGAIN && errno != EACCES)
+    {
+      throw std::system_error(errno, std::system_category(), "Could not lock attachment to shared memory segment");
+    }
+  }
+  throw std::runtime_error("Maximum number of objects attached to shared memory buffer pool exceeded");
+}
+
+bool tSharedMemoryBufferPool::IsAttached(uint32_t attachment_id) const
+{
+  struct flock lock;
+  if (LockAttachment(file_descriptor, F_OFD_GETLK, lock, attachment_id))
+  {
+    return true; // cannot determine: assume attached (buffers are not recovered)
+  }
+  return lock.l_type != F_UNLCK;
+}
+
+bool tSharedMemoryBufferPool::Unlink(const std::string& name)
+{
+  return shm_unlink(name.c_str()) == 0;
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
@@ -0,0 +1,330 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tSharedMemoryBufferPool.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tSharedMemoryBufferPool
+ *
+ * \b tSharedMemoryBufferPool
+ *
+ * Buffer pool in a shared memory segment - for zero-copy exchange of buffers among local processes.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tSharedMemoryBufferPool_h__
+#define __rrlib__buffer_pools__tSharedMemoryBufferPool_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/util/tNoncopyable.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Buffer pool in shared memory
+/*!
+ * Buffer pool whose buffers and management data reside in a shared memory segment
+ * (named POSIX shared memory or an anonymous memfd whose file descriptor is passed to other processes).
+ * Multiple local processes can map the same pool - each with its own tSharedMemoryBufferPool object -
+ * and acquire, fill, pass and recycle buffers without copying them.
+ *
+ * As the segment is mapped at different addresses in different processes, it contains no pointers:
+ * Buffers are identified by their index. Their location is computed from offsets in the segment header.
+ *
+ * Buffer management is lock-free and flag-based (as management::ArrayAndFlagBased).
+ * Every buffer has a 64 bit state word that contains its owner (attachment id), a generation and an 'in transit' flag.
+ * Every ownership transition is a single atomic operation on this word. Therefore, a process crashing at
+ * any point cannot leave the pool in an inconsistent state - and RecoverBuffers() can return all buffers
+ * owned by pool objects that no longer exist.
+ *
+ * Every pool object attaches to the segment under an attachment id of its own. While it exists, it holds an
+ * open file description lock (F_OFD_SETLK) on the byte of the segment file that corresponds to this id.
+ * The kernel releases this lock when the object is deleted or its process terminates - so liveness checks
+ * are neither affected by reuse of process ids nor by processes in different pid namespaces.
+ * A queue-based free-list was not used, since a process crashing between popping a buffer and
+ * recording itself as owner would lose this buffer.
+ *
+ * Buffers are passed to other processes with Pass() and Receive(): tTransferHandle is a small, trivially copyable
+ * struct that can be sent via any channel (e.g. a socket or a pipe). Stale handles (received twice, or
+ * recovered in the meantime) are detected via the generation.
+ *
+ * Note: Pool objects must not be used across fork() (a child process inherits the lock of the parent's objects).
+ */
+class tSharedMemoryBufferPool : private util::tNoncopyable
+{
+  struct tSegmentHeader;
+  struct tBufferState;
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! Returns buffers to this pool */
+  class tRecycler
+  {
+  public:
+    tRecycler() : pool(NULL) {}
+    tRecycler(tSharedMemoryBufferPool* pool) : pool(pool) {}
+
+    void operator()(uint8_t* buffer) const
+    {
+      pool->RecycleBuffer(buffer);
+    }
+
+  private:
+    tSharedMemoryBufferPool* pool;
+  };
+
+  /*! Pointer to buffer (size is GetBufferSize()). Returns buffer to pool when it goes out of scope. */
+  typedef std::unique_ptr<uint8_t, tRecycler> tPointer;
+
+  /*!
+   * Handle to pass buffer to another process (see Pass() and Receive())
+   */
+  struct tTransferHandle
+  {
+    /*! Index of buffer in pool */
+    uint32_t index;
+
+    /*! Generation of buffer (0 for null handle) */
+    uint32_t generation;
+  };
+
+  /*!
+   * Creates pool in new named shared memory segment (see shm_open)
+   *
+   * \param name Name of shared memory segment (e.g. "/sensor_buffers"). Must not exist yet.
+   * \param buffer_size Size of every buffer in bytes
+   * \param buffer_count Number of buffers
+   * \throw std::system_error if segment cannot be created or mapped
+   */
+  tSharedMemoryBufferPool(const std::string& name, size_t buffer_size, uint32_t buffer_count);
+
+  /*!
+   * Creates pool in new anonymous shared memory segment (see memfd_create).
+   * Other processes can open the pool with the file descriptor (see GetFileDescriptor()).
+   *
+   * \param buffer_size Size of every buffer in bytes
+   * \param buffer_count Number of buffers
+   * \throw std::system_error if segment cannot be created or mapped
+   */
+  tSharedMemoryBufferPool(size_t buffer_size, uint32_t buffer_count);
+
+  /*!
+   * Opens existing pool in named shared memory segment
+   *
+   * \param name Name of shared memory segment
+   * \throw std::system_error if segment cannot be opened or mapped
+   * \throw std::runtime_error if segment does not contain an (initialized) buffer pool
+   */
+  explicit tSharedMemoryBufferPool(const std::string& name);
+
+  /*!
+   * Opens existing pool in shared memory segment with specified file descriptor
+   * (e.g. received from another process via unix domain socket)
+   *
+   * \param file_descriptor File descriptor of shared memory segment (is duplicated - caller may close it)
+   * \throw std::system_error if segment cannot be mapped
+   * \throw std::runtime_error if segment does not contain an (initialized) buffer pool
+   */
+  explicit tSharedMemoryBufferPool(int file_descriptor);
+
+  /*!
+   * Unmaps segment. Buffers of this process that are still in use remain owned by this process
+   * (they can be recovered by RecoverBuffers() in another process once this process has terminated).
+   */
+  ~tSharedMemoryBufferPool();
+
+  /*!
+   * \return Number of buffers in pool
+   */
+  uint32_t GetBufferCount() const
+  {
+    return buffer_count;
+  }
+
+  /*!
+   * \return Size of every buffer in bytes
+   */
+  size_t GetBufferSize() const
+  {
+    return buffer_size;
+  }
+
+  /*!
+   * \return File descriptor of shared memory segment (owned by this object)
+   */
+  int GetFileDescriptor() const
+  {
+    return file_descriptor;
+  }
+
+  /*!
+   * Obtain unused buffer from pool
+   *
+   * \return Unused Buffer - Null if there is no unused buffer in pool
+   */
+  tPointer GetUnusedBuffer();
+
+  /*!
+   * Passes ownership of buffer to handle - e.g. to send it to another process.
+   * Until the handle is received, the buffer remains owned by this process with respect to recovery.
+   *
+   * \param buffer Buffer to pass. Is null after call.
+   * \return Handle to send to receiving process (null handle if buffer is null)
+   */
+  tTransferHandle Pass(tPointer && buffer);
+
+  /*!
+   * Takes over ownership of buffer passed with Pass()
+   *
+   * \param handle Handle obtained from Pass() - possibly in another process
+   * \return Buffer - Null if handle is stale (already received, recovered or null)
+   */
+  tPointer Receive(const tTransferHandle& handle);
+
+  /*!
+   * Returns all buffers to pool that are owned by pool objects that no longer exist - e.g. in crashed processes
+   * (including buffers passed by these objects that have not been received yet)
+   *
+   * \return Number of buffers recovered
+   */
+  size_t RecoverBuffers();
+
+  /*!
+   * Removes name of shared memory segment (processes that mapped the segment can continue using it)
+   *
+   * \param name Name of shared memory segment
+   * \return True if segment was removed
+   */
+  static bool Unlink(const std::string& name);
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! File descriptor of shared memory segment */
+  int file_descriptor;
+
+  /*! Start address and size of mapped segment */
+  void* segment;
+  size_t segment_size;
+
+  /*! Header of segment */
+  tSegmentHeader* header;
+
+  /*! States of buffers (in segment) */
+  tBufferState* states;
+
+  /*! First buffer (in segment) */
+  uint8_t* buffers;
+
+  /*! Size of every buffer and distance between buffers in bytes */
+  size_t buffer_size, buffer_stride;
+
+  /*! Number of buffers in pool */
+  uint32_t buffer_count;
+
+  /*! Attachment id of this object (owner of buffers in buffer states) */
+  uint32_t attachment_id;
+
+
+  tSharedMemoryBufferPool();
+
+  /*!
+   * Attaches this object to segment under an unused attachment id
+   * (buffers still owned by a previous object with this id are recovered)
+   *
+   * \throw std::system_error if locking fails, std::runtime_error if all attachment ids are in use
+   */
+  void Attach();
+
+  /*!
+   * \return Index of buffer in pool
+   */
+  uint32_t GetIndex(const uint8_t* buffer) const
+  {
+    return static_cast<uint32_t>((buffer - buffers) / buffer_stride);
+  }
+
+  /*!
+   * Creates pool in segment with file descriptor
+   */
+  void Initialize(size_t buffer_size, uint32_t buffer_count);
+
+  /*!
+   * Maps segment and sets pointers to its parts
+   *
+   * \param size Size of segment
+   */
+  void Map(size_t size);
+
+  /*!
+   * \param attachment_id Attachment id
+   * \return True if a pool object with this attachment id exists (in any process)
+   */
+  bool IsAttached(uint32_t attachment_id) const;
+
+  /*!
+   * Opens pool in segment with file descriptor (and attaches to it)
+   */
+  void Open();
+
+  /*!
+   * Returns buffer to pool (called by tRecycler)
+   */
+  void RecycleBuffer(uint8_t* buffer);
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
@@ -0,0 +1,219 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tSharedPointer.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tSharedPointer
+ *
+ * \b tSharedPointer
+ *
+ * Reference-counted pointer to a pooled buffer that recycles the buffer
+ * when the last reference is released.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tSharedPointer_h__
+#define __rrlib__buffer_pools__tSharedPointer_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tSharedBuffer.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Shared pointer to pooled buffer
+/*!
+ * Reference-counted pointer to a buffer from a tBufferPool - similar to std::shared_ptr.
+ * The reference counter is stored in the buffer (its type must be derived from tSharedBuffer).
+ * Therefore, sharing a buffer does not allocate any memory.
+ * When the last tSharedPointer to a buffer is destructed, the buffer is recycled.
+ *
+ * Typical use: a producer fills a buffer obtained as tBufferPool::tPointer
+ * and publishes it to several consumers (converted to tSharedPointer) - without copying it.
+ *
+ * TBufferPool  Type of buffer pool (tBufferPool<...>) that buffers originate from
+ */
+template <typename TBufferPool>
+class tSharedPointer
+{
+  typedef typename TBufferPool::tPointer tUniquePointer;
+  typedef typename tUniquePointer::element_type tBuffer;
+  typedef typename tUniquePointer::deleter_type tRecycler;
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  typedef tBuffer element_type;
+
+  tSharedPointer() : buffer(NULL), recycler() {}
+
+  /*!
+   * \param pointer Unique pointer to buffer. Is empty after call.
+   */
+  tSharedPointer(tUniquePointer && pointer) : buffer(pointer.get()), recycler(pointer.get_deleter())
+  {
+    static_assert(std::is_base_of<tSharedBuffer, tBuffer>::value, "Type of buffers must be subclass of tSharedBuffer for this pointer.");
+    pointer.release();
+    if (buffer)
+    {
+      ReferenceCount().store(1, std::memory_order_relaxed);
+    }
+  }
+
+  tSharedPointer(const tSharedPointer& other) : buffer(other.buffer), recycler(other.recycler)
+  {
+    if (buffer)
+    {
+      ReferenceCount().fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  tSharedPointer(tSharedPointer && other) : buffer(other.buffer), recycler(other.recycler)
+  {
+    other.buffer = NULL;
+  }
+
+  ~tSharedPointer()
+  {
+    reset();
+  }
+
+  tSharedPointer& operator=(tSharedPointer other)
+  {
+    swap(other);
+    return *this;
+  }
+
+  tBuffer* get() const
+  {
+    return buffer;
+  }
+
+  explicit operator bool() const
+  {
+    return buffer != NULL;
+  }
+
+  tBuffer& operator*() const
+  {
+    return *buffer;
+  }
+
+  tBuffer* operator->() const
+  {
+    return buffer;
+  }
+
+  /*!
+   * Releases reference to buffer. Buffer is recycled if this was the last reference.
+   */
+  void reset()
+  {
+    if (buffer)
+    {
+      if (ReferenceCount().fetch_sub(1, std::memory_order_release) == 1)
+      {
+        std::atomic_thread_fence(std::memory_order_acquire); // see all accesses of other owners before buffer is reused
+        recycler(buffer);
+      }
+      buffer = NULL;
+    }
+  }
+
+  void swap(tSharedPointer& other)
+  {
+    std::swap(buffer, other.buffer);
+    std::swap(recycler, other.recycler);
+  }
+
+  /*!
+   * \return Number of tSharedPointer objects that refer to buffer (0 if this pointer is empty)
+   */
+  size_t use_count() const
+  {
+    return buffer ? ReferenceCount().load(std::memory_order_relaxed) : 0;
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Buffer that this pointer refers to */
+  tBuffer* buffer;
+
+  /*! Recycler of tBufferPool::tPointer (stores buffer management info with some recycling policies) */
+  tRecycler recycler;
+
+
+  std::atomic<size_t>& ReferenceCount() const
+  {
+    return static_cast<tSharedBuffer&>(*buffer).reference_count;
+  }
+};
+
+template <typename TBufferPool>
+inline bool operator == (const tSharedPointer<TBufferPool>& pointer1, const tSharedPointer<TBufferPool>& pointer2)
+{
+  return pointer1.get() == pointer2.get();
+}
+
+template <typename TBufferPool>
+inline bool operator != (const tSharedPointer<TBufferPool>& pointer1, const tSharedPointer<TBufferPool>& pointer2)
+{
+  return pointer1.get() != pointer2.get();
+}
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
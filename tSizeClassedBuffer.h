@@ -0,0 +1,148 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tSizeClassedBuffer.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tSizeClassedBuffer
+ *
+ * \b tSizeClassedBuffer
+ *
+ * Byte buffer of fixed capacity for tSizeClassedBufferPool.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tSizeClassedBuffer_h__
+#define __rrlib__buffer_pools__tSizeClassedBuffer_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include "rrlib/concurrent_containers/tQueueable.h"
+#include "rrlib/util/tNoncopyable.h"
+#include <cstddef>
+#include <memory>
+#include <new>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tBufferManagementInfo.h"
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Byte buffer for size-classed pools
+/*!
+ * Byte buffer of fixed capacity. Header and data are allocated in one block of memory.
+ * As the header contains the buffer management info, buffers can be used with
+ * the UseOwnerStorageInBuffer recycling policy and all management policies.
+ */
+class tSizeClassedBuffer : public tBufferManagementInfo, public concurrent_containers::tQueueable<concurrent_containers::tQueueability::MOST_OPTIMIZED>, private util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*!
+   * Creates buffer
+   *
+   * \param capacity Capacity of buffer in bytes
+   * \return Created buffer
+   * \throw std::bad_alloc if no memory could be allocated
+   */
+  static std::unique_ptr<tSizeClassedBuffer> Create(size_t capacity)
+  {
+    return std::unique_ptr<tSizeClassedBuffer>(new(capacity) tSizeClassedBuffer(capacity));
+  }
+
+  /*!
+   * \return Capacity of buffer in bytes
+   */
+  size_t GetCapacity() const
+  {
+    return capacity;
+  }
+
+  /*!
+   * \return Pointer to buffer's data (suitably aligned for any fundamental type)
+   */
+  void* GetData()
+  {
+    return reinterpret_cast<char*>(this) + DataOffset();
+  }
+  const void* GetData() const
+  {
+    return reinterpret_cast<const char*>(this) + DataOffset();
+  }
+
+  static void operator delete(void* buffer)
+  {
+    ::operator delete(buffer);
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Capacity of buffer in bytes */
+  const size_t capacity;
+
+
+  tSizeClassedBuffer(size_t capacity) noexcept : capacity(capacity) {}
+
+  static size_t DataOffset()
+  {
+    return (sizeof(tSizeClassedBuffer) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+  }
+
+  static void* operator new(size_t size, size_t capacity)
+  {
+    return ::operator new(DataOffset() + capacity);
+  }
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
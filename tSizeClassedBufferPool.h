@@ -0,0 +1,246 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tSizeClassedBufferPool.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tSizeClassedBufferPool
+ *
+ * \b tSizeClassedBufferPool
+ *
+ * Pool of byte buffers of variable size - organized in power-of-two size classes.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tSizeClassedBufferPool_h__
+#define __rrlib__buffer_pools__tSizeClassedBufferPool_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tBufferPool.h"
+#include "rrlib/buffer_pools/tSizeClassedBuffer.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Pool of variable-sized byte buffers
+/*!
+ * Pool of byte buffers (tSizeClassedBuffer) with sizes ranging from a minimum to a maximum buffer size.
+ * Buffers are organized in power-of-two size classes - each of them is an ordinary tBufferPool.
+ *
+ * All size classes have the same tPointer type. As buffers store their owner (UseOwnerStorageInBuffer),
+ * they are recycled into their size class without storing any additional information.
+ *
+ * CONCURRENCY              Specifies whether pool is accessed by multiple threads concurrently (see tBufferPool)
+ * TBufferManagementPolicy  Buffer management policy of every size class
+ * TDeletingPolicy          Deleting policy of every size class
+ */
+template < concurrent_containers::tConcurrency CONCURRENCY = concurrent_containers::tConcurrency::FULL,
+         template <typename, concurrent_containers::tConcurrency, typename ...> class TBufferManagementPolicy = management::StackBased,
+         template <typename> class TDeletingPolicy = deleting::ComplainOnMissingBuffers,
+         typename... TBufferManagementPolicyArgs >
+class tSizeClassedBufferPool : private rrlib::util::tNoncopyable
+{
+
+//----------------------------------------------------------------------
+// Public methods and typedefs
+//----------------------------------------------------------------------
+public:
+
+  /*! Buffer pool of a single size class */
+  typedef tBufferPool < tSizeClassedBuffer, CONCURRENCY, TBufferManagementPolicy, TDeletingPolicy, recycling::UseOwnerStorageInBuffer,
+          std::default_delete<tSizeClassedBuffer>, TBufferManagementPolicyArgs... > tSizeClassPool;
+
+  typedef typename tSizeClassPool::tPointer tPointer;
+
+  /*!
+   * \param min_buffer_size Buffer size of smallest size class (is rounded up to power of two)
+   * \param max_buffer_size Buffer size of largest size class (is rounded up to power of two)
+   */
+  tSizeClassedBufferPool(size_t min_buffer_size = 64, size_t max_buffer_size = 4 * 1024 * 1024) :
+    min_size_log2(CeilLog2(min_buffer_size)),
+    size_class_count(CeilLog2(std::max(min_buffer_size, max_buffer_size)) - min_size_log2 + 1),
+    size_classes(new tSizeClassPool[size_class_count])
+  {}
+
+  /*!
+   * Creates and adds new buffer to pool
+   *
+   * \param min_size Minimum size of buffer in bytes (buffer size is the one of the smallest size class that fits)
+   * \return Buffer reference. May be used as unused buffer reference immediately (otherwise its automatically recycled by tPointer)
+   * \throw std::bad_alloc if no memory could be allocated
+   * \throw std::length_error if min_size exceeds maximum buffer size
+   */
+  tPointer AddBuffer(size_t min_size)
+  {
+    size_t size_class = GetSizeClass(min_size);
+    return size_classes[size_class].AddBuffer(tSizeClassedBuffer::Create(GetBufferSize(size_class)));
+  }
+
+  /*!
+   * \param size_class Index of size class
+   * \return Size of buffers in this size class
+   */
+  size_t GetBufferSize(size_t size_class) const
+  {
+    assert(size_class < size_class_count);
+    return static_cast<size_t>(1) << (min_size_log2 + size_class);
+  }
+
+  /*!
+   * \param min_size Minimum size of buffer in bytes
+   * \return Index of smallest size class with buffers of at least this size
+   * \throw std::length_error if min_size exceeds maximum buffer size
+   */
+  size_t GetSizeClass(size_t min_size) const
+  {
+    size_t size_class = min_size <= (static_cast<size_t>(1) << min_size_log2) ? 0 : CeilLog2(min_size) - min_size_log2;
+    if (size_class >= size_class_count)
+    {
+      throw std::length_error("Requested buffer size exceeds maximum buffer size of pool");
+    }
+    return size_class;
+  }
+
+  /*!
+   * \return Number of size classes
+   */
+  size_t GetSizeClassCount() const
+  {
+    return size_class_count;
+  }
+
+  /*!
+   * \param size_class Index of size class
+   * \return Buffer pool of this size class (e.g. to reserve or remove buffers)
+   */
+  tSizeClassPool& GetSizeClassPool(size_t size_class)
+  {
+    assert(size_class < size_class_count);
+    return size_classes[size_class];
+  }
+
+  /*!
+   * Obtain pointer to unused buffer in pool
+   *
+   * \param min_size Minimum size of buffer in bytes
+   * \param larger_size_classes If true, buffers from larger size classes are returned if smallest fitting size class contains no unused buffer
+   * \return Unused buffer from smallest fitting size class (that has an unused buffer) - Null if there is no such buffer
+   * \throw std::length_error if min_size exceeds maximum buffer size
+   */
+  tPointer GetUnusedBuffer(size_t min_size, bool larger_size_classes = false)
+  {
+    size_t size_class = GetSizeClass(min_size);
+    size_t end = larger_size_classes ? size_class_count : size_class + 1;
+    for (; size_class < end; size_class++)
+    {
+      tPointer buffer = size_classes[size_class].GetUnusedBuffer();
+      if (buffer)
+      {
+        return buffer;
+      }
+    }
+    return tPointer();
+  }
+
+  /*!
+   * Adds new buffers of a size class to pool - e.g. to populate pool at startup
+   *
+   * \param min_size Minimum size of buffers in bytes (determines size class)
+   * \param count Number of buffers to add
+   * \throw std::bad_alloc if no memory could be allocated (no buffers are added in this case)
+   * \throw std::length_error if min_size exceeds maximum buffer size
+   */
+  void Reserve(size_t min_size, size_t count)
+  {
+    size_t size_class = GetSizeClass(min_size);
+    size_t buffer_size = GetBufferSize(size_class);
+    size_classes[size_class].Reserve(count, [buffer_size]()
+    {
+      return tSizeClassedBuffer::Create(buffer_size);
+    });
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*! Binary logarithm of buffer size of smallest size class */
+  const size_t min_size_log2;
+
+  /*! Number of size classes */
+  const size_t size_class_count;
+
+  /*! Buffer pools of all size classes (index 0 contains smallest buffers) */
+  std::unique_ptr<tSizeClassPool[]> size_classes;
+
+
+  /*!
+   * \return Binary logarithm of value - rounded up
+   */
+  static size_t CeilLog2(size_t value)
+  {
+    size_t result = 0;
+    while ((static_cast<size_t>(1) << result) < value)
+    {
+      result++;
+    }
+    return result;
+  }
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
@@ -0,0 +1,238 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tSlabStorage.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tHeapSlabStorage and tHugePageSlabStorage
+ *
+ * \b tHeapSlabStorage
+ *
+ * Allocates slabs (see tBufferSlab) on the heap.
+ *
+ * \b tHugePageSlabStorage
+ *
+ * Allocates slabs (see tBufferSlab) in huge pages - if available.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tSlabStorage_h__
+#define __rrlib__buffer_pools__tSlabStorage_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+/*!
+ * Memory that slabs are backed by (from most to least TLB-friendly)
+ */
+enum class tSlabBacking
+{
+  HUGETLB_PAGES,           //!< Huge pages reserved for hugetlbfs (MAP_HUGETLB)
+  TRANSPARENT_HUGE_PAGES,  //!< Regular mapping that kernel is advised to back with transparent huge pages (MADV_HUGEPAGE)
+  REGULAR_PAGES,           //!< Regular mapping (huge pages not available)
+  HEAP                     //!< Heap memory
+};
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Heap storage for slabs
+/*!
+ * Allocates slabs of 64 KB on the heap (default storage of tBufferSlab)
+ */
+struct tHeapSlabStorage
+{
+  /*! Size of slabs in bytes (power of two) */
+  enum { cSLAB_SIZE = 64 * 1024 };
+
+  /*!
+   * \param backing Contains memory that slab is backed by after call
+   * \return Slab memory (aligned to cSLAB_SIZE)
+   * \throw std::bad_alloc if no memory could be allocated
+   */
+  static void* Allocate(tSlabBacking& backing)
+  {
+    void* memory = NULL;
+    if (posix_memalign(&memory, cSLAB_SIZE, cSLAB_SIZE))
+    {
+      throw std::bad_alloc();
+    }
+    backing = tSlabBacking::HEAP;
+    return memory;
+  }
+
+  static void Free(void* slab)
+  {
+    free(slab);
+  }
+};
+
+//! Huge page storage for slabs
+/*!
+ * Allocates slabs in 2 MB huge pages - so that thousands of buffers are covered by few TLB entries.
+ * Huge pages from the hugetlbfs pool (MAP_HUGETLB) are used if available.
+ * Otherwise, slabs are mapped with regular pages and the kernel is advised to back them with
+ * transparent huge pages (MADV_HUGEPAGE). If this is not possible either, slabs remain backed by regular pages.
+ * tBufferSlab::Create() and tBufferPool::AddSlabBuffers() report the backing actually obtained.
+ *
+ * SLAB_SIZE  Size of slabs in bytes (power of two - at least 2 MB)
+ */
+template <size_t SLAB_SIZE = 2 * 1024 * 1024>
+struct tHugePageSlabStorage
+{
+  /*! Size of huge pages (requested explicitly from hugetlbfs - default huge page size might be 1 GB) */
+  enum { cHUGE_PAGE_SIZE = 2 * 1024 * 1024 };
+
+  /*! Size of slabs in bytes (power of two) */
+  enum { cSLAB_SIZE = SLAB_SIZE };
+
+  static_assert(SLAB_SIZE >= cHUGE_PAGE_SIZE && (SLAB_SIZE & (SLAB_SIZE - 1)) == 0, "Slab size must be a power of two and at least 2 MB");
+
+  /*!
+   * \param backing Contains memory that slab is backed by after call
+   * \return Slab memory (aligned to cSLAB_SIZE)
+   * \throw std::bad_alloc if no memory could be mapped
+   */
+  static void* Allocate(tSlabBacking& backing)
+  {
+    void* memory = NULL;
+#ifdef MAP_HUGETLB
+#ifdef MAP_HUGE_2MB
+    memory = MapAligned(MAP_HUGETLB | MAP_HUGE_2MB);
+#else
+    memory = MapAligned(MAP_HUGETLB | (21 << 26)); // MAP_HUGE_2MB (log2 of page size << MAP_HUGE_SHIFT) - not defined by older C libraries
+#endif
+    if (memory)
+    {
+      backing = tSlabBacking::HUGETLB_PAGES;
+      return memory;
+    }
+#endif
+    memory = MapAligned(0);
+    if (!memory)
+    {
+      throw std::bad_alloc();
+    }
+    backing = tSlabBacking::REGULAR_PAGES;
+#ifdef MADV_HUGEPAGE
+    if (TransparentHugePagesEnabled() && madvise(memory, cSLAB_SIZE, MADV_HUGEPAGE) == 0)
+    {
+      backing = tSlabBacking::TRANSPARENT_HUGE_PAGES;
+    }
+#endif
+    return memory;
+  }
+
+  static void Free(void* slab)
+  {
+    munmap(slab, cSLAB_SIZE);
+  }
+
+//----------------------------------------------------------------------
+// Private fields and methods
+//----------------------------------------------------------------------
+private:
+
+  /*!
+   * Maps anonymous memory for slab aligned to cSLAB_SIZE.
+   * Maps twice the size and unmaps the excess, if mapping with slab size is not aligned.
+   *
+   * \param flags Additional flags for mmap
+   * \return Mapped memory - NULL if mapping failed
+   */
+  static void* MapAligned(int flags)
+  {
+    void* memory = mmap(NULL, cSLAB_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+      return NULL;
+    }
+    if ((reinterpret_cast<uintptr_t>(memory) & (cSLAB_SIZE - 1)) == 0)
+    {
+      return memory;
+    }
+    munmap(memory, cSLAB_SIZE);
+    char* area = static_cast<char*>(mmap(NULL, 2 * cSLAB_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0));
+    if (area == MAP_FAILED)
+    {
+      return NULL;
+    }
+    char* aligned = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(area) + cSLAB_SIZE - 1) & ~static_cast<uintptr_t>(cSLAB_SIZE - 1));
+    if (aligned > area)
+    {
+      munmap(area, aligned - area);
+    }
+    if (aligned + cSLAB_SIZE < area + 2 * cSLAB_SIZE)
+    {
+      munmap(aligned + cSLAB_SIZE, (area + 2 * cSLAB_SIZE) - (aligned + cSLAB_SIZE));
+    }
+    return aligned;
+  }
+
+  /*!
+   * \return False if transparent huge pages are disabled system-wide (or not supported)
+   */
+  static bool TransparentHugePagesEnabled()
+  {
+    static const bool enabled = []()
+    {
+      std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+      std::string setting;
+      return std::getline(file, setting) && setting.find("[never]") == std::string::npos;
+    }();
+    return enabled;
+  }
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
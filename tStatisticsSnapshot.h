@@ -0,0 +1,122 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tStatisticsSnapshot.h
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * \brief   Contains tStatisticsSnapshot
+ *
+ * \b tStatisticsSnapshot
+ *
+ * Snapshot of buffer pool statistics.
+ *
+ */
+//----------------------------------------------------------------------
+#ifndef __rrlib__buffer_pools__tStatisticsSnapshot_h__
+#define __rrlib__buffer_pools__tStatisticsSnapshot_h__
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <array>
+#include <cstddef>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Namespace declaration
+//----------------------------------------------------------------------
+namespace rrlib
+{
+namespace buffer_pools
+{
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Class declaration
+//----------------------------------------------------------------------
+//! Snapshot of buffer pool statistics
+/*!
+ * Values collected by a statistics policy (see management::WithStatistics).
+ * As counters are read one after another while the pool is in use,
+ * values may be slightly inconsistent with each other.
+ */
+struct tStatisticsSnapshot
+{
+  enum { cLATENCY_HISTOGRAM_SIZE = 64 };
+
+  /*! Number of buffers obtained from pool (hits) */
+  size_t acquisitions;
+
+  /*! Number of requests that could not be satisfied (completely) as there were not enough unused buffers */
+  size_t misses;
+
+  /*! Number of buffers added to pool */
+  size_t additions;
+
+  /*! Number of buffers recycled */
+  size_t recycles;
+
+  /*! Number of times a thread lost a race for an unused buffer and had to retry */
+  size_t claim_conflicts;
+
+  /*! Number of buffers currently in use */
+  size_t in_use;
+
+  /*! Maximum number of buffers in use at the same time (zero if not tracked) */
+  size_t peak_in_use;
+
+  /*! Number of sampled acquire-to-recycle latencies */
+  size_t latency_samples;
+
+  /*! Histogram of sampled acquire-to-recycle latencies: Element i counts latencies in [2^i, 2^(i+1)) nanoseconds */
+  std::array<size_t, cLATENCY_HISTOGRAM_SIZE> latency_histogram;
+
+
+  tStatisticsSnapshot() :
+    acquisitions(0), misses(0), additions(0), recycles(0), claim_conflicts(0), in_use(0), peak_in_use(0), latency_samples(0), latency_histogram()
+  {}
+
+  /*!
+   * \return Ratio of requests for unused buffers that could be satisfied
+   */
+  double GetHitRatio() const
+  {
+    return acquisitions + misses ? static_cast<double>(acquisitions) / (acquisitions + misses) : 1.0;
+  }
+};
+
+//----------------------------------------------------------------------
+// End of namespace declaration
+//----------------------------------------------------------------------
+}
+}
+
+
+#endif
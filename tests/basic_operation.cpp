@@ -34,11 +34,26 @@
 // External includes (system with <>, local with "")
 //----------------------------------------------------------------------
 #include "rrlib/util/tUnitTestSuite.h"
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
 
 //----------------------------------------------------------------------
 // Internal includes with ""
 //----------------------------------------------------------------------
 #include "rrlib/buffer_pools/tBufferPool.h"
+#include "rrlib/buffer_pools/tGarbageCollector.h"
+#include "rrlib/buffer_pools/tGrowingBufferPool.h"
+#include "rrlib/buffer_pools/tIdleBufferTrimmer.h"
+#include "rrlib/buffer_pools/tShardedBufferPool.h"
+#include "rrlib/buffer_pools/tSharedMemoryBufferPool.h"
+#include "rrlib/buffer_pools/tSharedPointer.h"
+#include "rrlib/buffer_pools/tSizeClassedBufferPool.h"
 
 //----------------------------------------------------------------------
 // Debugging
@@ -81,6 +96,34 @@ inline std::ostream& operator << (std::ostream& output, const tTestType& t)
   return output;
 }
 
+class tCountedTestType : public tTestType
+{
+public:
+  tCountedTestType(const std::string& content) : tTestType(content)
+  {
+    instances++;
+  }
+  ~tCountedTestType()
+  {
+    instances--;
+  }
+  static std::atomic<int> instances;
+};
+
+std::atomic<int> tCountedTestType::instances(0);
+
+class tSharedTestType : public tTestType, public tSharedBuffer
+{
+public:
+  tSharedTestType(const std::string& content) : tTestType(content) {}
+};
+
+class tHandleTestType : public tTestType, public tHandleBuffer
+{
+public:
+  tHandleTestType(const std::string& content) : tTestType(content) {}
+};
+
 template <typename T, typename TManaged, bool INSTANT_DELETE, typename TPool>
 void TestBufferPool(TPool* pool)
 {
@@ -97,6 +140,36 @@ void TestBufferPool(TPool* pool)
     RRLIB_LOG_PRINT(DEBUG_VERBOSE_1, "  Obtained buffer '", *pool->GetUnusedBuffer(), "'.");
   }
 
+  RRLIB_LOG_PRINT(DEBUG_VERBOSE_1, " Obtaining buffers in batches");
+  {
+    std::array<typename TPool::tPointer, 8> batch;
+    size_t obtained = pool->GetUnusedBuffers(batch.begin(), batch.end());
+    RRLIB_UNIT_TESTS_ASSERT(obtained >= 3 && obtained <= 4);
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+      RRLIB_UNIT_TESTS_ASSERT((batch[i].get() != NULL) == (i < obtained));
+    }
+    TPool::RecycleBuffers(batch.begin(), batch.end());
+    for (auto it = batch.begin(); it != batch.end(); ++it)
+    {
+      RRLIB_UNIT_TESTS_ASSERT(!(*it));
+    }
+    RRLIB_UNIT_TESTS_ASSERT(pool->GetUnusedBuffers(batch.begin(), batch.end(), true) == 0);
+    for (auto it = batch.begin(); it != batch.end(); ++it)
+    {
+      RRLIB_UNIT_TESTS_ASSERT(!(*it));
+    }
+    RRLIB_UNIT_TESTS_ASSERT(pool->GetUnusedBuffers(batch.begin(), batch.begin() + 3, true) == 3);
+    {
+      tRecyclingBatch<TPool, 2> recycling_batch;
+      for (auto it = batch.begin(); it != batch.end(); ++it)
+      {
+        recycling_batch.Add(std::move(*it));
+      }
+    }
+    RRLIB_UNIT_TESTS_ASSERT(pool->GetUnusedBuffers(batch.begin(), batch.begin() + 3, true) == 3);
+  }
+
   RRLIB_LOG_PRINT(DEBUG_VERBOSE_1, " Obtaining 5 buffers simultaneously");
   std::vector<typename TPool::tPointer> buffer_pointers;
   for (int i = 0; i < 5; ++i)
@@ -136,6 +209,18 @@ void TestBufferPool(TPool* pool)
   }
 }
 
+template <typename TPool>
+void TestReserveWithPool(size_t minimum_available_buffers)
+{
+  TPool pool;
+  pool.Reserve(1000, []()
+  {
+    return std::unique_ptr<typename TPool::tManagedType>(new typename TPool::tManagedType("reserved buffer"));
+  }, 4);
+  std::vector<typename TPool::tPointer> buffer_pointers(1000);
+  RRLIB_UNIT_TESTS_ASSERT(pool.GetUnusedBuffers(buffer_pointers.begin(), buffer_pointers.end()) >= minimum_available_buffers);
+}
+
 template < typename T,
          bool INSTANT_DELETE,
          template <typename, concurrent_containers::tConcurrency, typename ...> class TBufferManagementPolicy,
@@ -177,6 +262,26 @@ class BasicOperation : public util::tUnitTestSuite
 {
   RRLIB_UNIT_TESTS_BEGIN_SUITE(BasicOperation);
   RRLIB_UNIT_TESTS_ADD_TEST(Test);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestThreadLocalCache);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestNextFit);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestConcurrentAddBuffer);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestReserve);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestSlabBuffers);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestHugePageSlabBuffers);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestGrowingBufferPool);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestBlockingGetUnusedBuffer);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestShrink);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestStatistics);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestLeakTracking);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestStackBased);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestSizeClassedBufferPool);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestShardedBufferPool);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestDeleteOnLastReturn);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestGarbageCollection);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestConcurrentGarbage);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestSharedPointer);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestCompactHandles);
+  RRLIB_UNIT_TESTS_ADD_TEST(TestSharedMemoryBufferPool);
   RRLIB_UNIT_TESTS_END_SUITE;
 
   void Test()
@@ -196,6 +301,14 @@ class BasicOperation : public util::tUnitTestSuite
     TestBufferPoolWithAllConcurrencyLevels<tTestType, false, management::QueueBased, deleting::CollectGarbage, recycling::UseOwnerStorageInBuffer>(
       "Testing tBufferPool<tTestType, %s, management::QueueBased, deleting::CollectGarbage, recycling::UseOwnerStorageInBuffer>:");
 
+    // Queue-based with thread-local cache
+    TestBufferPoolWithAllConcurrencyLevels<tTestType, true, management::QueueBasedWithThreadLocalCache, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer>(
+      "Testing tBufferPool<tTestType, %s, management::QueueBasedWithThreadLocalCache, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer>:");
+    TestBufferPoolWithAllConcurrencyLevels<tTestType, true, management::QueueBasedWithThreadLocalCache, deleting::ComplainOnMissingBuffers, recycling::UseBufferContainer>(
+      "Testing tBufferPool<tTestType, %s, management::QueueBasedWithThreadLocalCache, deleting::ComplainOnMissingBuffers, recycling::UseBufferContainer>:");
+    TestBufferPoolWithAllConcurrencyLevels<tTestType, false, management::QueueBasedWithThreadLocalCache, deleting::CollectGarbage, recycling::UseOwnerStorageInBuffer>(
+      "Testing tBufferPool<tTestType, %s, management::QueueBasedWithThreadLocalCache, deleting::CollectGarbage, recycling::UseOwnerStorageInBuffer>:");
+
     // Array-based
     TestBufferPoolWithAllConcurrencyLevels<std::string, true, management::ArrayAndFlagBased, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer>(
       "Testing tBufferPool<std::string, %s, management::ArrayAndFlagBased, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer>:");
@@ -210,8 +323,1016 @@ class BasicOperation : public util::tUnitTestSuite
       "Testing tBufferPool<std::string, %s, management::ArrayAndFlagBased, deleting::CollectGarbage, recycling::UseBufferContainer>:");
     TestBufferPoolWithAllConcurrencyLevels<tTestType, false, management::ArrayAndFlagBased, deleting::CollectGarbage, recycling::UseOwnerStorageInBuffer>(
       "Testing tBufferPool<tTestType, %s, management::ArrayAndFlagBased, deleting::CollectGarbage, recycling::UseOwnerStorageInBuffer>:");
+    TestBufferPoolWithAllConcurrencyLevels<std::string, true, management::ArrayAndFlagBased, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer, thread::tMutex, management::NextFit>(
+      "Testing tBufferPool<std::string, %s, management::ArrayAndFlagBased, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer, thread::tMutex, management::NextFit>:");
+    TestBufferPoolWithAllConcurrencyLevels<tTestType, false, management::ArrayAndFlagBased, deleting::CollectGarbage, recycling::UseOwnerStorageInBuffer, thread::tMutex, management::NextFit>(
+      "Testing tBufferPool<tTestType, %s, management::ArrayAndFlagBased, deleting::CollectGarbage, recycling::UseOwnerStorageInBuffer, thread::tMutex, management::NextFit>:");
+    TestBufferPoolWithAllConcurrencyLevels<tTestType, true, management::ArrayAndFlagBased, deleting::ComplainOnMissingBuffers, recycling::UseOwnerStorageInBuffer, thread::tMutex, management::FirstFit, management::PaddedArrayChunks>(
+      "Testing tBufferPool<tTestType, %s, management::ArrayAndFlagBased, deleting::ComplainOnMissingBuffers, recycling::UseOwnerStorageInBuffer, thread::tMutex, management::FirstFit, management::PaddedArrayChunks>:");
+    TestBufferPoolWithAllConcurrencyLevels<std::string, false, management::ArrayAndFlagBased, deleting::CollectGarbage, recycling::StoreOwnerInUniquePointer, thread::tMutex, management::NextFit, management::ArrayChunkLayout<2, true>>(
+      "Testing tBufferPool<std::string, %s, management::ArrayAndFlagBased, deleting::CollectGarbage, recycling::StoreOwnerInUniquePointer, thread::tMutex, management::NextFit, management::ArrayChunkLayout<2, true>>:");
+
+    // Bitmap-based
+    TestBufferPoolWithAllConcurrencyLevels<std::string, true, management::BitmapBased, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer>(
+      "Testing tBufferPool<std::string, %s, management::BitmapBased, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer>:");
+    TestBufferPoolWithAllConcurrencyLevels<std::string, true, management::BitmapBased, deleting::ComplainOnMissingBuffers, recycling::UseBufferContainer>(
+      "Testing tBufferPool<std::string, %s, management::BitmapBased, deleting::ComplainOnMissingBuffers, recycling::UseBufferContainer>:");
+    TestBufferPoolWithAllConcurrencyLevels<std::string, false, management::BitmapBased, deleting::CollectGarbage, recycling::StoreOwnerInUniquePointer>(
+      "Testing tBufferPool<std::string, %s, management::BitmapBased, deleting::CollectGarbage, recycling::StoreOwnerInUniquePointer>:");
+    TestBufferPoolWithAllConcurrencyLevels<tTestType, false, management::BitmapBased, deleting::CollectGarbage, recycling::UseOwnerStorageInBuffer>(
+      "Testing tBufferPool<tTestType, %s, management::BitmapBased, deleting::CollectGarbage, recycling::UseOwnerStorageInBuffer>:");
+
+    // Stack-based
+    TestBufferPoolWithAllConcurrencyLevels<tTestType, true, management::StackBased, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer>(
+      "Testing tBufferPool<tTestType, %s, management::StackBased, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer>:");
+    TestBufferPoolWithAllConcurrencyLevels<std::string, true, management::StackBased, deleting::ComplainOnMissingBuffers, recycling::UseBufferContainer>(
+      "Testing tBufferPool<std::string, %s, management::StackBased, deleting::ComplainOnMissingBuffers, recycling::UseBufferContainer>:");
+    TestBufferPoolWithAllConcurrencyLevels<tTestType, true, management::StackBased, deleting::ComplainOnMissingBuffers, recycling::UseOwnerStorageInBuffer>(
+      "Testing tBufferPool<tTestType, %s, management::StackBased, deleting::ComplainOnMissingBuffers, recycling::UseOwnerStorageInBuffer>:");
+    TestBufferPoolWithAllConcurrencyLevels<std::string, false, management::StackBased, deleting::CollectGarbage, recycling::UseBufferContainer>(
+      "Testing tBufferPool<std::string, %s, management::StackBased, deleting::CollectGarbage, recycling::UseBufferContainer>:");
+    TestBufferPoolWithAllConcurrencyLevels<tTestType, false, management::StackBased, deleting::CollectGarbage, recycling::UseOwnerStorageInBuffer>(
+      "Testing tBufferPool<tTestType, %s, management::StackBased, deleting::CollectGarbage, recycling::UseOwnerStorageInBuffer>:");
+
+    // Delete on last return
+    TestBufferPoolWithAllConcurrencyLevels<tTestType, false, management::QueueBased, deleting::DeleteOnLastReturn, recycling::StoreOwnerInUniquePointer>(
+      "Testing tBufferPool<tTestType, %s, management::QueueBased, deleting::DeleteOnLastReturn, recycling::StoreOwnerInUniquePointer>:");
+    TestBufferPoolWithAllConcurrencyLevels<tTestType, false, management::StackBased, deleting::DeleteOnLastReturn, recycling::UseOwnerStorageInBuffer>(
+      "Testing tBufferPool<tTestType, %s, management::StackBased, deleting::DeleteOnLastReturn, recycling::UseOwnerStorageInBuffer>:");
+  }
+
+  void TestThreadLocalCache()
+  {
+    // Buffers in magazine of a terminated thread must be available to other threads
+    typedef tBufferPool<tTestType, concurrent_containers::tConcurrency::FULL, management::QueueBasedWithThreadLocalCache, deleting::ComplainOnMissingBuffers, recycling::UseOwnerStorageInBuffer> tPool;
+    tPool pool;
+    std::thread thread([&pool]()
+    {
+      for (int i = 0; i < 4; i++)
+      {
+        pool.AddBuffer(std::unique_ptr<tTestType>(new tTestType("thread buffer")));
+      }
+    });
+    thread.join();
+
+    std::vector<tPool::tPointer> buffer_pointers;
+    while (tPool::tPointer buffer = pool.GetUnusedBuffer())
+    {
+      buffer_pointers.push_back(std::move(buffer));
+    }
+    RRLIB_UNIT_TESTS_ASSERT(buffer_pointers.size() >= 3);
+
+    // Buffers in magazine of a running thread must be available to other threads
+    tPool other_pool;
+    RRLIB_UNIT_TESTS_ASSERT(!other_pool.GetUnusedBuffer()); // creates magazine of main thread
+    std::vector<tPool::tPointer> own_buffers;
+    for (int i = 0; i < 4; i++)
+    {
+      own_buffers.push_back(other_pool.AddBuffer(std::unique_ptr<tTestType>(new tTestType("main buffer"))));
+    }
+    own_buffers.clear();
+    size_t obtained_buffers = 0;
+    std::thread other_thread([&other_pool, &obtained_buffers]()
+    {
+      std::vector<tPool::tPointer> buffer_pointers;
+      while (tPool::tPointer buffer = other_pool.GetUnusedBuffer())
+      {
+        buffer_pointers.push_back(std::move(buffer));
+      }
+      obtained_buffers = buffer_pointers.size();
+    });
+    other_thread.join();
+    RRLIB_UNIT_TESTS_EQUALITY(size_t(4), obtained_buffers);
+  }
+
+  void TestNextFit()
+  {
+    // Search must wrap around to buffers in front of chunk of last acquisition
+    typedef tBufferPool<std::string, concurrent_containers::tConcurrency::FULL, management::ArrayAndFlagBased, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer,
+            std::default_delete<std::string>, thread::tMutex, management::NextFit> tPool;
+    tPool pool;
+    std::vector<tPool::tPointer> buffer_pointers;
+    for (int i = 0; i < 40; i++)
+    {
+      buffer_pointers.push_back(pool.AddBuffer(std::unique_ptr<std::string>(new std::string("buffer"))));
+    }
+    buffer_pointers.back().reset();
+    buffer_pointers.back() = pool.GetUnusedBuffer();
+    RRLIB_UNIT_TESTS_ASSERT(buffer_pointers.back().get() != NULL);
+    buffer_pointers.front().reset();
+    buffer_pointers.front() = pool.GetUnusedBuffer();
+    RRLIB_UNIT_TESTS_ASSERT(buffer_pointers.front().get() != NULL);
+    RRLIB_UNIT_TESTS_ASSERT(!pool.GetUnusedBuffer());
+  }
+
+  void TestConcurrentAddBuffer()
+  {
+    // All buffers added concurrently must be available
+    typedef tBufferPool<std::string, concurrent_containers::tConcurrency::FULL, management::ArrayAndFlagBased, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer> tPool;
+    tPool pool;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+    {
+      threads.emplace_back([&pool]()
+      {
+        for (int j = 0; j < 1000; j++)
+        {
+          pool.AddBuffer(std::unique_ptr<std::string>(new std::string("buffer")));
+        }
+      });
+    }
+    for (auto & thread : threads)
+    {
+      thread.join();
+    }
+
+    std::vector<tPool::tPointer> buffer_pointers;
+    while (tPool::tPointer buffer = pool.GetUnusedBuffer())
+    {
+      buffer_pointers.push_back(std::move(buffer));
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(buffer_pointers.size(), 4000u);
+
+    // Slots of buffers removed concurrently must be reused by exactly one buffer
+    buffer_pointers.clear();
+    std::atomic<int> running_threads(4);
+    threads.clear();
+    for (int i = 0; i < 4; i++)
+    {
+      threads.emplace_back([&pool, &running_threads]()
+      {
+        for (int j = 0; j < 2000; j++)
+        {
+          pool.AddBuffer(std::unique_ptr<std::string>(new std::string("buffer")));
+        }
+        running_threads--;
+      });
+    }
+    while (running_threads.load())
+    {
+      pool.RemoveUnusedBuffers(100);
+    }
+    for (auto & thread : threads)
+    {
+      thread.join();
+    }
+    std::set<std::string*> buffers;
+    while (tPool::tPointer buffer = pool.GetUnusedBuffer())
+    {
+      buffers.insert(buffer.get());
+      buffer_pointers.push_back(std::move(buffer));
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(buffers.size(), buffer_pointers.size());
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetBufferCount(), buffer_pointers.size());
+  }
+
+  void TestReserve()
+  {
+    // Buffers constructed in parallel must all be available
+    using concurrent_containers::tConcurrency;
+    TestReserveWithPool<tBufferPool<tTestType, tConcurrency::FULL, management::QueueBased>>(999);
+    TestReserveWithPool<tBufferPool<tTestType, tConcurrency::FULL, management::QueueBasedWithThreadLocalCache>>(999);
+    TestReserveWithPool<tBufferPool<std::string, tConcurrency::FULL, management::ArrayAndFlagBased>>(1000);
+    TestReserveWithPool<tBufferPool<std::string, tConcurrency::SINGLE_READER_AND_WRITER, management::BitmapBased, deleting::ComplainOnMissingBuffers, recycling::UseBufferContainer>>(1000);
+  }
+
+  void TestSlabBuffers()
+  {
+    // Buffers must be adjacent in memory; slabs must be freed with outstanding buffers after garbage collection
+    using concurrent_containers::tConcurrency;
+    typedef tBufferPool<std::string, tConcurrency::FULL, management::ArrayAndFlagBased, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer, tBufferSlab<std::string>::tDeleter> tArrayPool;
+    {
+      tArrayPool pool;
+      size_t count = tBufferSlab<std::string>::cBUFFERS_PER_SLAB + 10;
+      pool.AddSlabBuffers(count, "slab buffer");
+      std::vector<tArrayPool::tPointer> buffer_pointers(count + 1);
+      RRLIB_UNIT_TESTS_EQUALITY(pool.GetUnusedBuffers(buffer_pointers.begin(), buffer_pointers.end()), count);
+      RRLIB_UNIT_TESTS_ASSERT(buffer_pointers[1].get() == buffer_pointers[0].get() + 1);
+      RRLIB_UNIT_TESTS_EQUALITY(*buffer_pointers[count - 1], std::string("slab buffer"));
+    }
+
+    typedef tBufferPool<tTestType, tConcurrency::FULL, management::QueueBased, deleting::CollectGarbage, recycling::UseBufferContainer, tBufferSlab<tBufferContainer<tTestType>>::tDeleter> tQueuePool;
+    tQueuePool* pool = new tQueuePool();
+    pool->AddSlabBuffers(100, "slab buffer");
+    tQueuePool::tPointer buffer = pool->GetUnusedBuffer();
+    RRLIB_UNIT_TESTS_ASSERT(buffer.get() != NULL);
+    delete pool;
+    buffer.reset();
+    tGarbageFromDeletedBufferPools::DeleteGarbage();
+
+    // Buffers not handed out must be deleted if output throws
+    typedef tBufferSlab<tCountedTestType> tCountedSlab;
+    std::vector<std::unique_ptr<tCountedTestType, tCountedSlab::tDeleter>> handed_out;
+    try
+    {
+      tCountedSlab::Create(10, [&](tCountedTestType * buffer)
+      {
+        if (handed_out.size() == 3)
+        {
+          throw std::runtime_error("output failed");
+        }
+        handed_out.emplace_back(buffer);
+      }, "slab buffer");
+      RRLIB_UNIT_TESTS_ASSERT(false);
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(tCountedTestType::instances.load(), 3);
+    handed_out.clear();
+    RRLIB_UNIT_TESTS_EQUALITY(tCountedTestType::instances.load(), 0);
+  }
+
+  void TestHugePageSlabBuffers()
+  {
+    // Buffers must be adjacent in 2 MB aligned slabs - with whatever backing is available
+    typedef std::array<char, 4096> tPage;
+    typedef tBufferSlab<tPage, tHugePageSlabStorage<>> tSlab;
+    typedef tBufferPool<tPage, concurrent_containers::tConcurrency::FULL, management::ArrayAndFlagBased, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer, tSlab::tDeleter> tPool;
+    tPool pool;
+    RRLIB_UNIT_TESTS_ASSERT(pool.AddSlabBuffers(0) == tSlabBacking::HEAP); // no huge pages obtained
+    size_t count = tSlab::cBUFFERS_PER_SLAB + 10;
+    tSlabBacking backing = pool.AddSlabBuffers(count);
+    RRLIB_UNIT_TESTS_ASSERT(backing != tSlabBacking::HEAP);
+    std::vector<tPool::tPointer> buffer_pointers(count);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetUnusedBuffers(buffer_pointers.begin(), buffer_pointers.end()), count);
+    RRLIB_UNIT_TESTS_ASSERT(buffer_pointers[1].get() == buffer_pointers[0].get() + 1);
+    RRLIB_UNIT_TESTS_EQUALITY(reinterpret_cast<size_t>(buffer_pointers[0].get()) & ~(static_cast<size_t>(tSlab::cSLAB_SIZE) - 1), reinterpret_cast<size_t>(buffer_pointers[1].get()) & ~(static_cast<size_t>(tSlab::cSLAB_SIZE) - 1));
+    buffer_pointers[count - 1]->fill('x'); // memory must be writable
+  }
+
+  void TestGrowingBufferPool()
+  {
+    // Concurrent threads must not grow pool beyond its maximum number of buffers
+    typedef tBufferPool<std::string, concurrent_containers::tConcurrency::FULL, management::WithWaiting<management::ArrayAndFlagBased>::tPolicy> tPool;
+    tGrowingBufferPool<tPool> pool([]()
+    {
+      return std::unique_ptr<std::string>(new std::string("grown buffer"));
+    }, 100);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.Reserve(10), 10u);
+    std::vector<std::vector<tPool::tPointer>> buffer_pointers(4);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < buffer_pointers.size(); i++)
+    {
+      threads.emplace_back([&pool, &buffer_pointers, i]()
+      {
+        for (int j = 0; j < 50; j++)
+        {
+          tPool::tPointer buffer = pool.GetUnusedBuffer();
+          if (buffer)
+          {
+            buffer_pointers[i].push_back(std::move(buffer));
+          }
+        }
+      });
+    }
+    for (auto & thread : threads)
+    {
+      thread.join();
+    }
+    size_t obtained = 0;
+    for (auto & pointers : buffer_pointers)
+    {
+      obtained += pointers.size();
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(obtained, 100u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetBufferCount(), 100u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetGrowthCount(), 90u);
+    RRLIB_UNIT_TESTS_ASSERT(!pool.GetUnusedBuffer());
+
+    size_t to_release = 20;
+    for (auto & pointers : buffer_pointers)
+    {
+      size_t release = std::min(to_release, pointers.size());
+      pointers.resize(pointers.size() - release);
+      to_release -= release;
+    }
+    std::array<tPool::tPointer, 30> more_pointers;
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetUnusedBuffers(more_pointers.begin(), more_pointers.end(), true), 0u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetUnusedBuffers(more_pointers.begin(), more_pointers.end()), 20u);
+    RRLIB_UNIT_TESTS_ASSERT(!pool.GetUnusedBuffer(std::chrono::milliseconds(1)));
+
+    // Underlying pool must not be accessible (would bypass maximum number of buffers)
+    RRLIB_UNIT_TESTS_ASSERT(!(std::is_convertible<tGrowingBufferPool<tPool>&, tPool&>::value));
+  }
+
+  template <typename TPool>
+  void TestBlockingGetUnusedBuffer()
+  {
+    TPool pool;
+    std::vector<typename TPool::tPointer> held_buffers;
+    for (int i = 0; i < 2; i++)
+    {
+      held_buffers.push_back(pool.AddBuffer(std::unique_ptr<typename TPool::tManagedType>(new typename TPool::tManagedType("buffer"))));
+    }
+    RRLIB_UNIT_TESTS_ASSERT(!pool.GetUnusedBuffer(std::chrono::milliseconds(10)));
+    std::thread thread([&held_buffers]()
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      held_buffers.clear();
+    });
+    RRLIB_UNIT_TESTS_ASSERT(pool.GetUnusedBuffer(std::chrono::seconds(10)).get() != NULL);
+    thread.join();
+
+    // Buffers recycled in batches must wake up waiting threads as well
+    held_buffers.push_back(pool.GetUnusedBuffer());
+    held_buffers.push_back(pool.GetUnusedBuffer());
+    std::thread batch_thread([&held_buffers]()
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      TPool::RecycleBuffers(held_buffers.begin(), held_buffers.end());
+    });
+    RRLIB_UNIT_TESTS_ASSERT(pool.GetUnusedBuffer(std::chrono::seconds(10)).get() != NULL);
+    batch_thread.join();
+  }
+
+  void TestBlockingGetUnusedBuffer()
+  {
+    // Waiting threads must be woken up by recycled buffers and time out otherwise
+    using concurrent_containers::tConcurrency;
+    TestBlockingGetUnusedBuffer<tBufferPool<tTestType, tConcurrency::FULL, management::WithWaiting<management::QueueBased>::tPolicy>>();
+    TestBlockingGetUnusedBuffer<tBufferPool<tTestType, tConcurrency::FULL, management::WithWaiting<management::StackBased>::tPolicy, deleting::ComplainOnMissingBuffers, recycling::UseOwnerStorageInBuffer>>();
+    TestBlockingGetUnusedBuffer<tBufferPool<std::string, tConcurrency::FULL, management::WithWaiting<management::ArrayAndFlagBased>::tPolicy>>();
+    TestBlockingGetUnusedBuffer<tBufferPool<std::string, tConcurrency::FULL, management::WithWaiting<management::BitmapBased>::tPolicy>>();
+
+    // Pools whose management policy knows the owner of recycled buffers must be distributed among event counts
+    typedef tBufferPool<std::string, tConcurrency::FULL, management::WithWaiting<management::BitmapBased>::tPolicy> tBitmapPool;
+    std::vector<std::unique_ptr<tBitmapPool>> pools;
+    std::set<tEventCount*> events;
+    for (int i = 0; i < 16; i++)
+    {
+      pools.emplace_back(new tBitmapPool());
+      events.insert(&pools.back()->InternalBufferManagement().RecycleEvent());
+    }
+    RRLIB_UNIT_TESTS_ASSERT(events.size() > 1);
+
+    // Recycling last buffer concurrently to deletion of pool must not access deleted pool (e.g. when notifying waiting threads)
+    typedef tBufferPool<tTestType, tConcurrency::FULL, management::WithWaiting<management::StackBased>::tPolicy, deleting::CollectGarbage, recycling::UseOwnerStorageInBuffer> tCollectedPool;
+    tGarbageFromDeletedBufferPools::DeleteGarbage();
+    for (int i = 0; i < 100; i++)
+    {
+      tCollectedPool* pool = new tCollectedPool();
+      tCollectedPool::tPointer buffer = pool->AddBuffer(std::unique_ptr<tTestType>(new tTestType("buffer")));
+      delete pool;
+      std::thread thread([&buffer]()
+      {
+        buffer.reset();
+      });
+      while (tGarbageFromDeletedBufferPools::DeleteGarbage().remaining_pools)
+      {
+      }
+      thread.join();
+    }
+  }
+
+  template <typename TPool>
+  void TestShrink()
+  {
+    TPool pool;
+    std::vector<typename TPool::tPointer> held_buffers;
+    for (int i = 0; i < 200; i++)
+    {
+      held_buffers.push_back(pool.AddBuffer(std::unique_ptr<typename TPool::tManagedType>(new typename TPool::tManagedType("buffer"))));
+    }
+    held_buffers.resize(10);
+    RRLIB_UNIT_TESTS_ASSERT(pool.GetUnusedBufferCount() <= 190u && pool.GetUnusedBufferCount() + 1 >= 190u); // queue-based pools keep one buffer
+    RRLIB_UNIT_TESTS_EQUALITY(pool.RemoveUnusedBuffers(50), 50u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetBufferCount(), 150u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.ShrinkTo(100), 50u);
+
+    tIdleBufferTrimmer<TPool> trimmer(pool, 20, std::chrono::milliseconds(0));
+    RRLIB_UNIT_TESTS_EQUALITY(trimmer.Trim(), 80u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetBufferCount(), 20u);
+    held_buffers.clear();
+    pool.ShrinkTo(0);
+    RRLIB_UNIT_TESTS_ASSERT(pool.GetBufferCount() <= 1u); // queue-based pools keep one buffer
+
+    for (int i = 0; i < 20; i++)
+    {
+      held_buffers.push_back(pool.AddBuffer(std::unique_ptr<typename TPool::tManagedType>(new typename TPool::tManagedType("buffer"))));
+    }
+    held_buffers.clear();
+    RRLIB_UNIT_TESTS_ASSERT(pool.GetUnusedBuffer().get() != NULL);
+  }
+
+  void TestShrink()
+  {
+    // Unused buffers must be removed - and pools must remain usable afterwards
+    using concurrent_containers::tConcurrency;
+    TestShrink<tBufferPool<tTestType, tConcurrency::FULL, management::QueueBased>>();
+    TestShrink<tBufferPool<tTestType, tConcurrency::FULL, management::QueueBasedWithThreadLocalCache>>();
+    TestShrink<tBufferPool<tTestType, tConcurrency::FULL, management::StackBased>>();
+    TestShrink<tBufferPool<std::string, tConcurrency::FULL, management::ArrayAndFlagBased>>();
+    TestShrink<tBufferPool<std::string, tConcurrency::SINGLE_READER_AND_WRITER, management::ArrayAndFlagBased>>();
+    TestShrink<tBufferPool<std::string, tConcurrency::FULL, management::BitmapBased>>();
+
+    TestArrayChunkReclamation<tBufferPool<std::string, tConcurrency::FULL, management::ArrayAndFlagBased>>();
+    TestArrayChunkReclamation<tBufferPool<std::string, tConcurrency::SINGLE_READER_AND_WRITER, management::ArrayAndFlagBased>>();
+    TestBitmapChunkReuse<tBufferPool<std::string, tConcurrency::FULL, management::BitmapBased>>(false);
+    TestBitmapChunkReuse<tBufferPool<std::string, tConcurrency::SINGLE_READER_AND_WRITER, management::BitmapBased>>(true);
+  }
+
+  template <typename TPool>
+  void TestBitmapChunkReuse(bool chunks_deleted)
+  {
+    // Slots of removed buffers must be reused - and chunks without buffers deleted (single reader) or reused (multiple readers)
+    TPool pool;
+    std::vector<typename TPool::tPointer> held_buffers;
+    for (int i = 0; i < 10; i++)
+    {
+      held_buffers.push_back(pool.AddBuffer(std::unique_ptr<std::string>(new std::string("held"))));
+    }
+    size_t peak_chunk_count = 0;
+    for (int round = 0; round < 5; round++)
+    {
+      std::vector<typename TPool::tPointer> buffers;
+      for (int i = 0; i < 1000; i++)
+      {
+        buffers.push_back(pool.AddBuffer(std::unique_ptr<std::string>(new std::string("buffer"))));
+      }
+      peak_chunk_count = std::max(peak_chunk_count, pool.InternalBufferManagement().GetChunkCount());
+      RRLIB_UNIT_TESTS_EQUALITY(pool.InternalBufferManagement().GetChunkCount(), peak_chunk_count);
+      buffers.clear();
+      RRLIB_UNIT_TESTS_EQUALITY(pool.RemoveUnusedBuffers(10000), 1000u);
+      RRLIB_UNIT_TESTS_EQUALITY(pool.GetBufferCount(), 10u);
+      RRLIB_UNIT_TESTS_EQUALITY(pool.InternalBufferManagement().GetChunkCount(), chunks_deleted ? 1u : peak_chunk_count);
+    }
+
+    // Holes left by removed buffers are filled before new chunks are added
+    std::vector<typename TPool::tPointer> buffers;
+    for (int i = 0; i < 200; i++)
+    {
+      buffers.push_back(pool.AddBuffer(std::unique_ptr<std::string>(new std::string("buffer"))));
+    }
+    const size_t chunk_count = pool.InternalBufferManagement().GetChunkCount();
+    for (size_t i = 0; i < buffers.size(); i += 2)
+    {
+      buffers[i].reset();
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(pool.RemoveUnusedBuffers(10000), 100u);
+    for (int i = 0; i < 100; i++)
+    {
+      held_buffers.push_back(pool.AddBuffer(std::unique_ptr<std::string>(new std::string("buffer"))));
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetBufferCount(), 210u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.InternalBufferManagement().GetChunkCount(), chunk_count);
+    held_buffers.clear();
+    buffers.clear();
+    RRLIB_UNIT_TESTS_ASSERT(pool.GetUnusedBuffer().get() != NULL);
+  }
+
+  template <typename TPool>
+  void TestArrayChunkReclamation()
+  {
+    // Slots of removed buffers must be reused and array chunks beyond the last buffer reclaimed
+    TPool pool;
+    std::vector<typename TPool::tPointer> held_buffers;
+    for (int i = 0; i < 10; i++)
+    {
+      held_buffers.push_back(pool.AddBuffer(std::unique_ptr<std::string>(new std::string("held"))));
+    }
+    const size_t base_chunk_count = pool.InternalBufferManagement().GetArrayChunkCount();
+
+    for (int round = 0; round < 5; round++)
+    {
+      std::vector<typename TPool::tPointer> buffers;
+      for (int i = 0; i < 2000; i++)
+      {
+        buffers.push_back(pool.AddBuffer(std::unique_ptr<std::string>(new std::string("buffer"))));
+      }
+      RRLIB_UNIT_TESTS_ASSERT(pool.InternalBufferManagement().GetArrayChunkCount() > base_chunk_count);
+      buffers.clear();
+      RRLIB_UNIT_TESTS_EQUALITY(pool.RemoveUnusedBuffers(10000), 2000u);
+      RRLIB_UNIT_TESTS_EQUALITY(pool.GetBufferCount(), 10u);
+      RRLIB_UNIT_TESTS_EQUALITY(pool.InternalBufferManagement().GetArrayChunkCount(), base_chunk_count);
+    }
+
+    // Holes left by removed buffers are filled before the array grows
+    std::vector<typename TPool::tPointer> buffers;
+    for (int i = 0; i < 100; i++)
+    {
+      buffers.push_back(pool.AddBuffer(std::unique_ptr<std::string>(new std::string("buffer"))));
+    }
+    const size_t chunk_count = pool.InternalBufferManagement().GetArrayChunkCount();
+    for (size_t i = 0; i < buffers.size(); i += 2)
+    {
+      buffers[i].reset();
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(pool.RemoveUnusedBuffers(10000), 50u);
+    for (int i = 0; i < 50; i++)
+    {
+      held_buffers.push_back(pool.AddBuffer(std::unique_ptr<std::string>(new std::string("buffer"))));
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetBufferCount(), 110u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.InternalBufferManagement().GetArrayChunkCount(), chunk_count);
+    held_buffers.clear();
+    buffers.clear();
+    RRLIB_UNIT_TESTS_ASSERT(pool.GetUnusedBuffer().get() != NULL);
+  }
+
+  void TestStatistics()
+  {
+    // Operations must be counted; disabled statistics must yield plain management policy
+    using concurrent_containers::tConcurrency;
+    static_assert(std::is_same<management::WithStatistics<management::ArrayAndFlagBased, statistics::None>::tPolicy<std::string, tConcurrency::FULL, std::default_delete<std::string>>,
+                  management::ArrayAndFlagBased<std::string, tConcurrency::FULL, std::default_delete<std::string>>>::value, "Disabled statistics must not change management policy");
+
+    typedef tBufferPool<std::string, tConcurrency::FULL, management::WithStatistics<management::ArrayAndFlagBased, statistics::ShardedCounters<1, true>>::tPolicy> tPool;
+    tPool pool;
+    std::vector<tPool::tPointer> held_buffers;
+    for (int i = 0; i < 3; i++)
+    {
+      held_buffers.push_back(pool.AddBuffer(std::unique_ptr<std::string>(new std::string("buffer"))));
+    }
+    RRLIB_UNIT_TESTS_ASSERT(!pool.GetUnusedBuffer());
+    held_buffers.clear();
+    held_buffers.push_back(pool.GetUnusedBuffer());
+    held_buffers.push_back(pool.GetUnusedBuffer());
+    tStatisticsSnapshot statistics = pool.GetStatistics();
+    RRLIB_UNIT_TESTS_EQUALITY(statistics.additions, 3u);
+    RRLIB_UNIT_TESTS_EQUALITY(statistics.acquisitions, 2u);
+    RRLIB_UNIT_TESTS_EQUALITY(statistics.misses, 1u);
+    RRLIB_UNIT_TESTS_EQUALITY(statistics.recycles, 3u);
+    RRLIB_UNIT_TESTS_EQUALITY(statistics.in_use, 2u);
+    RRLIB_UNIT_TESTS_EQUALITY(statistics.peak_in_use, 3u);
+
+    held_buffers.clear();
+    statistics = pool.GetStatistics();
+    RRLIB_UNIT_TESTS_EQUALITY(statistics.in_use, 0u);
+    RRLIB_UNIT_TESTS_EQUALITY(statistics.latency_samples, 2u);
+
+    // Sampling idle buffers must not affect statistics
+    tIdleBufferTrimmer<tPool> trimmer(pool, 0, std::chrono::hours(1));
+    RRLIB_UNIT_TESTS_EQUALITY(trimmer.Trim(), 0u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetStatistics().acquisitions, 2u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetStatistics().recycles, 5u);
+
+    // Every pool must have statistics of its own
+    tPool other_pool;
+    other_pool.AddBuffer(std::unique_ptr<std::string>(new std::string("buffer")));
+    RRLIB_UNIT_TESTS_EQUALITY(other_pool.GetStatistics().additions, 1u);
+    RRLIB_UNIT_TESTS_EQUALITY(other_pool.GetStatistics().recycles, 1u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetStatistics().additions, 3u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetStatistics().recycles, 5u);
+
+    typedef tBufferPool<tTestType, tConcurrency::FULL, management::WithStatistics<management::QueueBased, statistics::ShardedCounters<1>>::tPolicy> tQueuePool;
+    tQueuePool pool1, pool2;
+    pool1.AddBuffer(std::unique_ptr<tTestType>(new tTestType("buffer")));
+    pool1.AddBuffer(std::unique_ptr<tTestType>(new tTestType("buffer")));
+    pool2.AddBuffer(std::unique_ptr<tTestType>(new tTestType("buffer")));
+    pool1.GetUnusedBuffer();
+    RRLIB_UNIT_TESTS_EQUALITY(pool1.GetStatistics().additions, 2u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool1.GetStatistics().recycles, 3u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool2.GetStatistics().additions, 1u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool2.GetStatistics().recycles, 1u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool2.GetStatistics().acquisitions, 0u);
+  }
+
+  void TestLeakTracking()
+  {
+    // Outstanding buffers must be tracked until they are recycled
+    typedef tBufferPool<std::string, concurrent_containers::tConcurrency::FULL, management::WithLeakTracking<management::ArrayAndFlagBased, 4>::tPolicy> tPool;
+    tPool* pool = new tPool();
+    std::vector<tPool::tPointer> held_buffers;
+    for (int i = 0; i < 3; i++)
+    {
+      held_buffers.push_back(pool->AddBuffer(std::unique_ptr<std::string>(new std::string("buffer"))));
+    }
+    held_buffers.pop_back();
+    RRLIB_UNIT_TESTS_EQUALITY(pool->InternalBufferManagement().GetOutstandingBufferCount(), 2u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    held_buffers.push_back(pool->GetUnusedBuffer());
+    RRLIB_UNIT_TESTS_EQUALITY(pool->DumpOutstandingBuffers(std::chrono::milliseconds(10)), 2u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool->DumpOutstandingBuffers(), 3u);
+
+    // Missing buffer is reported when pool is deleted
+    std::unique_ptr<std::string> missing_buffer(held_buffers.back().release());
+    held_buffers.clear();
+    delete pool;
+  }
+
+  void TestStackBased()
+  {
+    // Most recently recycled buffer must be reused first
+    typedef tBufferPool<tTestType, concurrent_containers::tConcurrency::FULL, management::StackBased, deleting::ComplainOnMissingBuffers, recycling::UseOwnerStorageInBuffer> tPool;
+    tPool pool;
+    tPool::tPointer first = pool.AddBuffer(std::unique_ptr<tTestType>(new tTestType("first")));
+    tPool::tPointer second = pool.AddBuffer(std::unique_ptr<tTestType>(new tTestType("second")));
+    first.reset();
+    second.reset();
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetUnusedBuffer()->content, std::string("second"));
+
+    // Buffers must neither be lost nor handed out twice under contention
+    for (int i = 0; i < 6; i++)
+    {
+      pool.AddBuffer(std::unique_ptr<tTestType>(new tTestType("buffer")));
+    }
+    std::atomic<bool> duplicate(false);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+    {
+      threads.emplace_back([&pool, &duplicate]()
+      {
+        for (int j = 0; j < 20000; j++)
+        {
+          std::array<tPool::tPointer, 2> buffers;
+          size_t obtained = pool.GetUnusedBuffers(buffers.begin(), buffers.end());
+          for (size_t k = 0; k < obtained; k++)
+          {
+            if (buffers[k]->content == "taken")
+            {
+              duplicate = true;
+            }
+            buffers[k]->content = "taken";
+          }
+          for (size_t k = 0; k < obtained; k++)
+          {
+            buffers[k]->content = "buffer";
+          }
+          tPool::RecycleBuffers(buffers.begin(), buffers.end());
+        }
+      });
+    }
+    for (auto & thread : threads)
+    {
+      thread.join();
+    }
+    RRLIB_UNIT_TESTS_ASSERT(!duplicate);
+    std::vector<tPool::tPointer> buffers(10);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetUnusedBuffers(buffers.begin(), buffers.end()), 8u);
+  }
+
+  void TestSizeClassedBufferPool()
+  {
+    typedef tSizeClassedBufferPool<> tPool;
+    tPool pool(64, 4 * 1024 * 1024);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetSizeClassCount(), 17u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetSizeClass(1), 0u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetSizeClass(65), 1u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetBufferSize(pool.GetSizeClass(1000)), 1024u);
+
+    // Buffers must be recycled into their size class
+    pool.Reserve(100, 2);
+    pool.AddBuffer(5000).reset();
+    RRLIB_UNIT_TESTS_ASSERT(!pool.GetUnusedBuffer(1000));
+    tPool::tPointer small_buffer = pool.GetUnusedBuffer(100);
+    RRLIB_UNIT_TESTS_EQUALITY(small_buffer->GetCapacity(), 128u);
+    std::fill_n(static_cast<char*>(small_buffer->GetData()), small_buffer->GetCapacity(), 0);
+    small_buffer.reset();
+    tPool::tPointer large_buffer = pool.GetUnusedBuffer(1000, true);
+    RRLIB_UNIT_TESTS_EQUALITY(large_buffer->GetCapacity(), 8192u);
+    large_buffer.reset();
+    std::array<tPool::tPointer, 3> buffers;
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetSizeClassPool(1).GetUnusedBuffers(buffers.begin(), buffers.end()), 2u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetSizeClassPool(7).GetUnusedBuffers(buffers.begin() + 2, buffers.end()), 1u);
+
+    bool length_error = false;
+    try
+    {
+      pool.GetUnusedBuffer(5 * 1024 * 1024);
+    }
+    catch (const std::length_error&)
+    {
+      length_error = true;
+    }
+    RRLIB_UNIT_TESTS_ASSERT(length_error);
+  }
+
+  template <typename TPool>
+  void TestShardedBufferPoolWithRecycling(bool recycle_to_current_shard)
+  {
+    TPool pool(4, tShardSelection::THREAD);
+    size_t local = pool.GetCurrentShardIndex();
+    typename TPool::tPointer buffer = pool.AddBuffer(std::unique_ptr<tTestType>(new tTestType("buffer")));
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetShard(local).GetBufferCount(), 1u);
+
+    // Other thread must steal buffer from local shard - and recycle it according to policy
+    buffer.reset();
+    size_t other = local;
+    std::thread thread([&]()
+    {
+      other = pool.GetCurrentShardIndex();
+      typename TPool::tPointer stolen = pool.GetUnusedBuffer();
+      RRLIB_UNIT_TESTS_ASSERT(stolen && stolen->content == "buffer");
+      RRLIB_UNIT_TESTS_ASSERT(!pool.GetUnusedBuffer());
+    });
+    thread.join();
+    RRLIB_UNIT_TESTS_ASSERT(other != local);
+    size_t home = recycle_to_current_shard ? other : local;
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetShard(home).GetBufferCount(), 1u);
+    RRLIB_UNIT_TESTS_ASSERT(pool.GetShard(home).GetUnusedBuffer());
+  }
+
+  void TestShardedBufferPool()
+  {
+    typedef tBufferPool<tTestType, concurrent_containers::tConcurrency::FULL, management::StackBased, deleting::ComplainOnMissingBuffers, recycling::UseOwnerStorageInBuffer> tShard;
+    TestShardedBufferPoolWithRecycling<tShardedBufferPool<tShard>>(false);
+    TestShardedBufferPoolWithRecycling<tShardedBufferPool<tShard, tShardRecycling::CURRENT_SHARD>>(true);
+    typedef tBufferPool<tTestType, concurrent_containers::tConcurrency::FULL, management::StackBased, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer> tOwnerInPointerShard;
+    TestShardedBufferPoolWithRecycling<tShardedBufferPool<tOwnerInPointerShard, tShardRecycling::CURRENT_SHARD>>(true);
+
+    // With CURRENT_SHARD, buffers refer to sharded pool: outstanding buffers must be tracked - also when returned by other threads
+    typedef tShardedBufferPool<tShard, tShardRecycling::CURRENT_SHARD> tPool;
+    std::unique_ptr<tPool> pool(new tPool(4, tShardSelection::THREAD));
+    std::vector<tPool::tPointer> buffers;
+    for (int i = 0; i < 8; i++)
+    {
+      buffers.push_back(pool->AddBuffer(std::unique_ptr<tTestType>(new tTestType("buffer"))));
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(pool->GetOutstandingBufferCount(), 8u);
+    std::thread thread([&]()
+    {
+      buffers.resize(2);
+      buffers.push_back(pool->GetUnusedBuffer());
+    });
+    thread.join();
+    RRLIB_UNIT_TESTS_EQUALITY(pool->GetOutstandingBufferCount(), 3u);
+    buffers.clear();
+    RRLIB_UNIT_TESTS_EQUALITY(pool->GetOutstandingBufferCount(), 0u);
+    RRLIB_UNIT_TESTS_EQUALITY(tShardedBufferPool<tShard>(2).GetOutstandingBufferCount(), 0u);
+    pool.reset(); // asserts that all buffers have been returned
+  }
+
+  void TestDeleteOnLastReturn()
+  {
+    // Pool must be deleted when last buffer in use is returned
+    typedef tBufferPool<tCountedTestType, concurrent_containers::tConcurrency::FULL, management::StackBased, deleting::DeleteOnLastReturn, recycling::UseOwnerStorageInBuffer> tPool;
+    tPool* pool = new tPool();
+    std::vector<tPool::tPointer> buffers;
+    for (int i = 0; i < 4; i++)
+    {
+      buffers.push_back(pool->AddBuffer(std::unique_ptr<tCountedTestType>(new tCountedTestType("buffer"))));
+    }
+    buffers.pop_back();
+    RRLIB_UNIT_TESTS_EQUALITY(tCountedTestType::instances.load(), 4);
+    delete pool;
+    RRLIB_UNIT_TESTS_EQUALITY(tCountedTestType::instances.load(), 3);
+    buffers.pop_back();
+    {
+      tRecyclingBatch<tPool> batch;
+      batch.Add(std::move(buffers.back()));
+      buffers.pop_back();
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(tCountedTestType::instances.load(), 3);
+    buffers.clear();
+    RRLIB_UNIT_TESTS_EQUALITY(tCountedTestType::instances.load(), 0);
+  }
+
+  void TestGarbageCollection()
+  {
+    typedef tBufferPool<tTestType, concurrent_containers::tConcurrency::FULL, management::StackBased, deleting::CollectGarbage, recycling::UseOwnerStorageInBuffer> tPool;
+    tGarbageFromDeletedBufferPools::DeleteGarbage();
+    std::vector<tPool::tPointer> buffers;
+    for (int i = 0; i < 3; i++)
+    {
+      tPool pool;
+      pool.AddBuffer(std::unique_ptr<tTestType>(new tTestType("unused buffer")));
+      buffers.push_back(pool.AddBuffer(std::unique_ptr<tTestType>(new tTestType("buffer in use"))));
+    }
+    buffers.clear();
+
+    // Incremental deletion must check no more than the specified number of pools
+    tGarbageFromDeletedBufferPools::tCollectionResult result = tGarbageFromDeletedBufferPools::DeleteGarbage(1);
+    RRLIB_UNIT_TESTS_EQUALITY(result.reclaimed_pools, 1u);
+    RRLIB_UNIT_TESTS_EQUALITY(result.reclaimed_buffers, 1u);
+    RRLIB_UNIT_TESTS_EQUALITY(result.reclaimed_bytes, sizeof(tTestType));
+    RRLIB_UNIT_TESTS_EQUALITY(result.remaining_pools, 2u);
+
+    // Collector thread must delete remaining pools
+    tGarbageCollector collector(std::chrono::milliseconds(1));
+    for (int i = 0; i < 1000 && collector.GetTotals().reclaimed_pools < 2; i++)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(collector.GetTotals().reclaimed_pools, 2u);
+    RRLIB_UNIT_TESTS_EQUALITY(collector.GetTotals().remaining_pools, 0u);
+  }
+
+  void TestConcurrentGarbage()
+  {
+    // Pools must not get lost when they become garbage while garbage is deleted
+    typedef tBufferPool<tCountedTestType, concurrent_containers::tConcurrency::FULL, management::StackBased, deleting::CollectGarbage, recycling::UseOwnerStorageInBuffer> tPool;
+    tGarbageFromDeletedBufferPools::DeleteGarbage();
+    int initial_instances = tCountedTestType::instances.load();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+    {
+      threads.emplace_back([]()
+      {
+        for (int j = 0; j < 200; j++)
+        {
+          tPool::tPointer buffer;
+          {
+            tPool pool;
+            buffer = pool.AddBuffer(std::unique_ptr<tCountedTestType>(new tCountedTestType("buffer")));
+          }
+        }
+      });
+    }
+    for (int i = 0; i < 100; i++)
+    {
+      tGarbageFromDeletedBufferPools::DeleteGarbage(4);
+    }
+    for (auto & thread : threads)
+    {
+      thread.join();
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(tGarbageFromDeletedBufferPools::DeleteGarbage().remaining_pools, 0u);
+    RRLIB_UNIT_TESTS_EQUALITY(tCountedTestType::instances.load(), initial_instances);
+  }
+
+  template <typename TPool>
+  void TestSharedPointerWithPool()
+  {
+    TPool pool;
+    pool.AddBuffer(std::unique_ptr<typename TPool::tManagedType>(new typename TPool::tManagedType("published"))).reset();
+    tSharedPointer<TPool> published(pool.GetUnusedBuffer());
+    RRLIB_UNIT_TESTS_EQUALITY(published.use_count(), 1u);
+
+    // Buffer must be recycled when last of the consumers releases it
+    std::vector<std::thread> consumers;
+    std::atomic<int> received(0);
+    for (int i = 0; i < 4; i++)
+    {
+      tSharedPointer<TPool> copy = published;
+      consumers.emplace_back([copy, &received]() mutable
+      {
+        if (copy->content == "published")
+        {
+          received++;
+        }
+        copy.reset();
+      });
+    }
+    tSharedPointer<TPool> moved(std::move(published));
+    RRLIB_UNIT_TESTS_ASSERT(!published);
+    moved.reset();
+    for (auto & consumer : consumers)
+    {
+      consumer.join();
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(received.load(), 4);
+    RRLIB_UNIT_TESTS_ASSERT(pool.GetUnusedBuffer());
   }
 
+  void TestSharedPointer()
+  {
+    TestSharedPointerWithPool<tBufferPool<tSharedTestType, concurrent_containers::tConcurrency::FULL, management::StackBased, deleting::ComplainOnMissingBuffers, recycling::UseOwnerStorageInBuffer>>();
+    TestSharedPointerWithPool<tBufferPool<tSharedTestType, concurrent_containers::tConcurrency::FULL, management::ArrayAndFlagBased, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer>>();
+  }
+
+  template <typename TPool>
+  void TestCompactHandlesWithPool()
+  {
+    typedef typename TPool::tRecycler tRecycler;
+    static_assert(sizeof(typename TPool::tPointer) == sizeof(void*), "Pointers should have the size of one pointer");
+
+    std::unique_ptr<TPool> pool(new TPool());
+    pool->AddBuffer(std::unique_ptr<tHandleTestType>(new tHandleTestType("first"))).reset();
+    pool->AddBuffer(std::unique_ptr<tHandleTestType>(new tHandleTestType("second"))).reset();
+
+    // Pass buffer through 32 bit atomic slot
+    std::atomic<uint32_t> slot(tRecycler::ToHandle(pool->GetUnusedBuffer()).GetRawValue());
+    tBufferHandle handle(slot.load());
+    RRLIB_UNIT_TESTS_ASSERT(handle && tRecycler::GetBuffer(handle));
+    std::string content = tRecycler::GetBuffer(handle)->content;
+    typename TPool::tPointer buffer = tRecycler::FromHandle(handle);
+    RRLIB_UNIT_TESTS_ASSERT(buffer && buffer->content == content);
+
+    // Stale handles: resolved before, buffer recycled and reused
+    RRLIB_UNIT_TESTS_ASSERT(!tRecycler::FromHandle(handle));
+    buffer.reset();
+    std::vector<tBufferHandle> handles;
+    for (typename TPool::tPointer next = pool->GetUnusedBuffer(); next; next = pool->GetUnusedBuffer())
+    {
+      handles.push_back(tRecycler::ToHandle(std::move(next)));
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(handles.size(), 2u);
+    RRLIB_UNIT_TESTS_ASSERT(!tRecycler::FromHandle(handle) && !tRecycler::GetBuffer(handle));
+    RRLIB_UNIT_TESTS_ASSERT(!tRecycler::FromHandle(tBufferHandle()));
+
+    // Concurrent resolution: every handle is resolved exactly once
+    std::atomic<int> resolved(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+    {
+      threads.emplace_back([&]()
+      {
+        for (auto & handle : handles)
+        {
+          if (tRecycler::FromHandle(handle))
+          {
+            resolved++;
+          }
+        }
+      });
+    }
+    for (auto & thread : threads)
+    {
+      thread.join();
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(resolved.load(), 2);
+
+    // Handles of deleted pool are stale
+    tBufferHandle last_handle = tRecycler::ToHandle(pool->GetUnusedBuffer());
+    tRecycler::FromHandle(last_handle).reset();
+    uint32_t pool_id = pool->InternalBufferManagement().GetPoolId();
+    pool.reset();
+    RRLIB_UNIT_TESTS_ASSERT(!tRecycler::FromHandle(last_handle));
+
+    // Handles of deleted pool must remain stale when pool id is reused
+    std::unique_ptr<TPool> next_pool(new TPool());
+    RRLIB_UNIT_TESTS_EQUALITY(next_pool->InternalBufferManagement().GetPoolId(), pool_id);
+    next_pool->AddBuffer(std::unique_ptr<tHandleTestType>(new tHandleTestType("next pool"))).reset();
+    handles.push_back(handle);
+    handles.push_back(last_handle);
+    for (int i = 0; i < 8; i++) // new buffer passes through generations that stale handles refer to
+    {
+      tBufferHandle next_handle = tRecycler::ToHandle(next_pool->GetUnusedBuffer());
+      RRLIB_UNIT_TESTS_EQUALITY(next_handle.GetIndex(), 0u);
+      for (auto & stale_handle : handles)
+      {
+        RRLIB_UNIT_TESTS_ASSERT(!tRecycler::FromHandle(stale_handle));
+      }
+      typename TPool::tPointer next_buffer = tRecycler::FromHandle(next_handle);
+      RRLIB_UNIT_TESTS_ASSERT(next_buffer && next_buffer->content == "next pool");
+    }
+  }
+
+  void TestCompactHandles()
+  {
+    TestCompactHandlesWithPool<tBufferPool<tHandleTestType, concurrent_containers::tConcurrency::FULL, management::ArrayAndFlagBased, deleting::ComplainOnMissingBuffers, recycling::UseCompactHandles>>();
+    TestCompactHandlesWithPool<tBufferPool<tHandleTestType, concurrent_containers::tConcurrency::FULL, management::StackBased, deleting::DeleteOnLastReturn, recycling::UseCompactHandles>>();
+  }
+
+  void TestSharedMemoryBufferPool()
+  {
+    tSharedMemoryBufferPool pool(4096, 4);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.GetBufferCount(), 4u);
+
+    // Pass buffer to child process via pipe - and back
+    tSharedMemoryBufferPool::tPointer buffer = pool.GetUnusedBuffer();
+    strcpy(reinterpret_cast<char*>(buffer.get()), "request");
+    tSharedMemoryBufferPool::tTransferHandle handle = pool.Pass(std::move(buffer));
+    int pipe_fds[2];
+    RRLIB_UNIT_TESTS_ASSERT(pipe(pipe_fds) == 0);
+    pid_t child = fork();
+    if (child == 0)
+    {
+      // Child opens pool itself, replies and crashes while holding a buffer
+      tSharedMemoryBufferPool child_pool(pool.GetFileDescriptor());
+      tSharedMemoryBufferPool::tPointer received = child_pool.Receive(handle);
+      bool ok = received && strcmp(reinterpret_cast<char*>(received.get()), "request") == 0 && (!child_pool.Receive(handle));
+      if (received)
+      {
+        strcpy(reinterpret_cast<char*>(received.get()), "reply");
+      }
+      tSharedMemoryBufferPool::tTransferHandle reply = child_pool.Pass(std::move(received));
+      child_pool.GetUnusedBuffer().release();
+      ok = ok && write(pipe_fds[1], &reply, sizeof(reply)) == sizeof(reply);
+      _exit(ok ? 0 : 1);
+    }
+    tSharedMemoryBufferPool::tTransferHandle reply;
+    RRLIB_UNIT_TESTS_ASSERT(read(pipe_fds[0], &reply, sizeof(reply)) == sizeof(reply));
+    int status = 0;
+    waitpid(child, &status, 0);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    RRLIB_UNIT_TESTS_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    buffer = pool.Receive(reply);
+    RRLIB_UNIT_TESTS_ASSERT(buffer && strcmp(reinterpret_cast<char*>(buffer.get()), "reply") == 0);
+    RRLIB_UNIT_TESTS_ASSERT(!pool.Receive(handle));
+
+    // Buffer of crashed child is recovered
+    std::vector<tSharedMemoryBufferPool::tPointer> buffers;
+    buffers.push_back(std::move(buffer));
+    while ((buffer = pool.GetUnusedBuffer()))
+    {
+      buffers.push_back(std::move(buffer));
+    }
+    RRLIB_UNIT_TESTS_EQUALITY(buffers.size(), 3u);
+    RRLIB_UNIT_TESTS_EQUALITY(pool.RecoverBuffers(), 1u);
+    RRLIB_UNIT_TESTS_ASSERT(pool.GetUnusedBuffer());
+
+    // Buffers of other pool object are only recovered after it has been deleted (regardless of process id)
+    buffers.push_back(pool.GetUnusedBuffer());
+    buffers.erase(buffers.begin());
+    std::unique_ptr<tSharedMemoryBufferPool> other_pool(new tSharedMemoryBufferPool(pool.GetFileDescriptor()));
+    other_pool->Receive(pool.Pass(std::move(buffers.back()))).release();
+    RRLIB_UNIT_TESTS_EQUALITY(pool.RecoverBuffers(), 0u);
+    other_pool.reset();
+    RRLIB_UNIT_TESTS_EQUALITY(pool.RecoverBuffers(), 1u);
+    buffers.clear();
+
+    // Named segment
+    std::string name = "/rrlib_buffer_pools_test_" + std::to_string(getpid());
+    tSharedMemoryBufferPool named_pool(name, 100, 2);
+    tSharedMemoryBufferPool opened_pool(name);
+    tSharedMemoryBufferPool::Unlink(name);
+    RRLIB_UNIT_TESTS_EQUALITY(opened_pool.GetBufferSize(), 100u);
+    tSharedMemoryBufferPool::tPointer named_buffer = opened_pool.Receive(named_pool.Pass(named_pool.GetUnusedBuffer()));
+    RRLIB_UNIT_TESTS_ASSERT(named_buffer && named_pool.GetUnusedBuffer() && (!named_pool.GetUnusedBuffer()));
+  }
 };
 
 RRLIB_UNIT_TESTS_REGISTER_SUITE(BasicOperation);
@@ -0,0 +1,121 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tests/benchmark_array_chunk_layout.cpp
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * Compares acquire/recycle throughput of ArrayAndFlagBased buffer pools
+ * with packed and padded array chunk layouts at 1, 4 and 16 threads.
+ *
+ */
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tBufferPool.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+using namespace rrlib::buffer_pools;
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+const std::chrono::milliseconds cDURATION(1000);
+const int cBUFFERS_PER_THREAD = 4;
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+
+template <typename TArrayChunkLayout>
+double MeasureThroughput(int thread_count)
+{
+  typedef tBufferPool < size_t, rrlib::concurrent_containers::tConcurrency::FULL, management::ArrayAndFlagBased, deleting::ComplainOnMissingBuffers, recycling::StoreOwnerInUniquePointer,
+          std::default_delete<size_t>, rrlib::thread::tMutex, management::FirstFit, TArrayChunkLayout > tPool;
+  tPool pool;
+  for (int i = 0; i < thread_count * cBUFFERS_PER_THREAD; i++)
+  {
+    pool.AddBuffer(std::unique_ptr<size_t>(new size_t(0)));
+  }
+
+  std::atomic<bool> stop(false);
+  std::atomic<size_t> total_operations(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count; i++)
+  {
+    threads.emplace_back([&]()
+    {
+      size_t operations = 0;
+      while (!stop.load(std::memory_order_relaxed))
+      {
+        typename tPool::tPointer buffer = pool.GetUnusedBuffer();
+        if (buffer)
+        {
+          (*buffer)++;
+          operations++;
+        }
+      }
+      total_operations += operations;
+    });
+  }
+  std::this_thread::sleep_for(cDURATION);
+  stop = true;
+  for (auto & thread : threads)
+  {
+    thread.join();
+  }
+  return total_operations / std::chrono::duration<double>(cDURATION).count();
+}
+
+int main()
+{
+  const int cTHREAD_COUNTS[] = { 1, 4, 16 };
+  for (int thread_count : cTHREAD_COUNTS)
+  {
+    double packed = MeasureThroughput<management::PackedArrayChunks>(thread_count);
+    double padded = MeasureThroughput<management::PaddedArrayChunks>(thread_count);
+    RRLIB_LOG_PRINT(USER, thread_count, " thread(s): packed ", packed / 1000000, " Mops/s, padded ", padded / 1000000, " Mops/s (", (padded / packed - 1) * 100, "%)");
+  }
+  return 0;
+}
@@ -0,0 +1,400 @@
+//
+// You received this file as part of RRLib
+// Robotics Research Library
+//
+// Copyright (C) Finroc GbR (finroc.org)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+//----------------------------------------------------------------------
+/*!\file    rrlib/buffer_pools/tests/benchmark_policy_matrix.cpp
+ *
+ * \author  agent
+ *
+ * \date    2026-10-16
+ *
+ * Measures acquire/recycle throughput of buffer pools for all combinations
+ * of management, deleting and recycling policies and concurrency levels -
+ * with 1 to N threads pinned to CPUs and a new/delete baseline for comparison.
+ * If perf_event_open is available, cycles, instructions and cache misses per
+ * operation are measured as well. Results are printed as CSV.
+ *
+ * Usage: benchmark_policy_matrix [max threads] [duration per measurement in ms]
+ *
+ */
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// External includes (system with <>, local with "")
+//----------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <mutex>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+//----------------------------------------------------------------------
+// Internal includes with ""
+//----------------------------------------------------------------------
+#include "rrlib/buffer_pools/tBufferPool.h"
+
+//----------------------------------------------------------------------
+// Debugging
+//----------------------------------------------------------------------
+#include <cassert>
+
+//----------------------------------------------------------------------
+// Namespace usage
+//----------------------------------------------------------------------
+using namespace rrlib::buffer_pools;
+using rrlib::concurrent_containers::tConcurrency;
+
+//----------------------------------------------------------------------
+// Forward declarations / typedefs / enums
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// Const values
+//----------------------------------------------------------------------
+const int cBUFFERS_PER_THREAD = 4;
+
+/*! Number of operations between checks whether measurement is over */
+const size_t cOPERATIONS_PER_CHECK = 64;
+
+//----------------------------------------------------------------------
+// Implementation
+//----------------------------------------------------------------------
+
+/*! Buffer type that is compatible with all policies */
+class tBenchmarkBuffer : public rrlib::concurrent_containers::tQueueable<rrlib::concurrent_containers::tQueueability::MOST_OPTIMIZED>, public tBufferManagementInfo
+{
+public:
+  tBenchmarkBuffer() : value(0) {}
+  size_t value;
+};
+
+/*! Values of hardware performance counters */
+struct tCounterValues
+{
+  uint64_t cycles, instructions, cache_misses;
+
+  tCounterValues() : cycles(0), instructions(0), cache_misses(0) {}
+};
+
+/*!
+ * Hardware performance counters of calling thread (via perf_event_open).
+ * Counters are not available e.g. on virtual machines without PMU or if perf_event_paranoid forbids it.
+ */
+class tPerformanceCounters
+{
+public:
+
+  tPerformanceCounters() : file_descriptors { -1, -1, -1 }
+  {
+    const uint64_t cEVENTS[3] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES };
+    for (int i = 0; i < 3; i++)
+    {
+      perf_event_attr attributes;
+      memset(&attributes, 0, sizeof(attributes));
+      attributes.type = PERF_TYPE_HARDWARE;
+      attributes.size = sizeof(attributes);
+      attributes.config = cEVENTS[i];
+      attributes.disabled = (i == 0);
+      attributes.exclude_kernel = 1;
+      attributes.exclude_hv = 1;
+      attributes.read_format = PERF_FORMAT_GROUP;
+      file_descriptors[i] = syscall(__NR_perf_event_open, &attributes, 0, -1, file_descriptors[0], 0);
+      if (file_descriptors[i] < 0)
+      {
+        Close();
+        return;
+      }
+    }
+  }
+
+  ~tPerformanceCounters()
+  {
+    Close();
+  }
+
+  bool Available() const
+  {
+    return file_descriptors[0] >= 0;
+  }
+
+  void Start()
+  {
+    if (Available())
+    {
+      ioctl(file_descriptors[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(file_descriptors[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+  }
+
+  /*!
+   * \param values Counter values are added to this object
+   * \return Whether counters could be read
+   */
+  bool Stop(tCounterValues& values)
+  {
+    if (!Available())
+    {
+      return false;
+    }
+    ioctl(file_descriptors[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    uint64_t data[4]; // number of counters + values
+    if (read(file_descriptors[0], data, sizeof(data)) != sizeof(data) || data[0] != 3)
+    {
+      return false;
+    }
+    values.cycles += data[1];
+    values.instructions += data[2];
+    values.cache_misses += data[3];
+    return true;
+  }
+
+private:
+
+  int file_descriptors[3];
+
+  void Close()
+  {
+    for (int i = 2; i >= 0; i--)
+    {
+      if (file_descriptors[i] >= 0)
+      {
+        close(file_descriptors[i]);
+        file_descriptors[i] = -1;
+      }
+    }
+  }
+};
+
+/*! Result of a measurement */
+struct tResult
+{
+  size_t operations;
+  double seconds;
+  tCounterValues counters;
+  bool counters_valid;
+};
+
+/*!
+ * Runs operation in a loop on the specified number of threads (pinned to CPUs)
+ *
+ * \param thread_count Number of threads
+ * \param duration Duration of measurement
+ * \param operation Operation to measure. Returns whether it was successful (only successful operations are counted).
+ */
+template <typename TOperation>
+tResult RunThreads(int thread_count, std::chrono::milliseconds duration, TOperation operation)
+{
+  tResult result;
+  result.operations = 0;
+  result.counters_valid = true;
+  std::atomic<int> ready_threads(0);
+  std::atomic<bool> start(false), stop(false);
+  std::mutex result_mutex;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count; i++)
+  {
+    threads.emplace_back([&]()
+    {
+      tPerformanceCounters counters;
+      size_t operations = 0;
+      ready_threads++;
+      while (!start.load(std::memory_order_acquire))
+      {
+        std::this_thread::yield();
+      }
+      counters.Start();
+      while (!stop.load(std::memory_order_relaxed))
+      {
+        for (size_t j = 0; j < cOPERATIONS_PER_CHECK; j++)
+        {
+          operations += operation() ? 1 : 0;
+        }
+      }
+      tCounterValues values;
+      bool counters_valid = counters.Stop(values);
+
+      std::lock_guard<std::mutex> lock(result_mutex);
+      result.operations += operations;
+      result.counters.cycles += values.cycles;
+      result.counters.instructions += values.instructions;
+      result.counters.cache_misses += values.cache_misses;
+      result.counters_valid &= counters_valid;
+    });
+
+    int cpu_count = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(i % cpu_count, &cpu_set);
+    pthread_setaffinity_np(threads.back().native_handle(), sizeof(cpu_set), &cpu_set); // failure (e.g. restricted cpuset) is not critical
+  }
+
+  while (ready_threads.load() < thread_count)
+  {
+    std::this_thread::yield();
+  }
+  auto start_time = std::chrono::steady_clock::now();
+  start.store(true, std::memory_order_release);
+  std::this_thread::sleep_for(duration);
+  stop = true;
+  for (auto & thread : threads)
+  {
+    thread.join();
+  }
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  return result;
+}
+
+void PrintResult(const char* management, const char* deleting, const char* recycling, const char* concurrency, int thread_count, const tResult& result)
+{
+  double operations = std::max<double>(1, result.operations);
+  printf("%s,%s,%s,%s,%d,%zu,%.2f,%.3f,", management, deleting, recycling, concurrency, thread_count, result.operations,
+         result.seconds * thread_count * 1e9 / operations, result.operations / result.seconds / 1e6);
+  if (result.counters_valid)
+  {
+    printf("%.1f,%.1f,%.3f\n", result.counters.cycles / operations, result.counters.instructions / operations, result.counters.cache_misses / operations);
+  }
+  else
+  {
+    printf(",,\n");
+  }
+  fflush(stdout);
+}
+
+/*!
+ * \return Thread counts to measure (1, 2, 4, ... and max_threads)
+ */
+std::vector<int> GetThreadCounts(int max_threads)
+{
+  std::vector<int> result;
+  for (int i = 1; i < max_threads; i *= 2)
+  {
+    result.push_back(i);
+  }
+  result.push_back(max_threads);
+  return result;
+}
+
+void MeasureBaseline(int max_threads, std::chrono::milliseconds duration)
+{
+  for (int thread_count : GetThreadCounts(max_threads))
+  {
+    tResult result = RunThreads(thread_count, duration, []()
+    {
+      std::unique_ptr<tBenchmarkBuffer> buffer(new tBenchmarkBuffer());
+      buffer->value++;
+      asm volatile("" : : "g"(buffer.get()) : "memory"); // prevent compiler from eliding allocation
+      return true;
+    });
+    PrintResult("new/delete", "", "", "", thread_count, result);
+  }
+}
+
+template < tConcurrency CONCURRENCY,
+         template <typename, tConcurrency, typename ...> class TBufferManagementPolicy,
+         template <typename> class TDeletingPolicy,
+         template <typename, typename> class TRecycling >
+void MeasurePool(const char* management, const char* deleting, const char* recycling, const char* concurrency, int max_threads, std::chrono::milliseconds duration)
+{
+  typedef tBufferPool<tBenchmarkBuffer, CONCURRENCY, TBufferManagementPolicy, TDeletingPolicy, TRecycling> tPool;
+
+  // Each thread acquires and recycles buffers - so only pools with full concurrency may be used by multiple threads
+  std::vector<int> thread_counts = GetThreadCounts(CONCURRENCY == tConcurrency::FULL ? max_threads : 1);
+  for (int thread_count : thread_counts)
+  {
+    tPool* pool = new tPool();
+    for (int i = 0; i < thread_count * cBUFFERS_PER_THREAD; i++)
+    {
+      pool->AddBuffer(std::unique_ptr<typename tPool::tManagedType>(new typename tPool::tManagedType()));
+    }
+    tResult result = RunThreads(thread_count, duration, [pool]()
+    {
+      typename tPool::tPointer buffer = pool->GetUnusedBuffer();
+      if (buffer)
+      {
+        buffer->value++;
+        return true;
+      }
+      return false;
+    });
+    delete pool;
+    PrintResult(management, deleting, recycling, concurrency, thread_count, result);
+  }
+}
+
+template < template <typename, tConcurrency, typename ...> class TBufferManagementPolicy,
+         template <typename> class TDeletingPolicy,
+         template <typename, typename> class TRecycling >
+void MeasureAllConcurrencyLevels(const char* management, const char* deleting, const char* recycling, int max_threads, std::chrono::milliseconds duration)
+{
+  MeasurePool<tConcurrency::NONE, TBufferManagementPolicy, TDeletingPolicy, TRecycling>(management, deleting, recycling, "NONE", max_threads, duration);
+  MeasurePool<tConcurrency::SINGLE_READER_AND_WRITER, TBufferManagementPolicy, TDeletingPolicy, TRecycling>(management, deleting, recycling, "SINGLE_READER_AND_WRITER", max_threads, duration);
+  MeasurePool<tConcurrency::MULTIPLE_WRITERS, TBufferManagementPolicy, TDeletingPolicy, TRecycling>(management, deleting, recycling, "MULTIPLE_WRITERS", max_threads, duration);
+  MeasurePool<tConcurrency::MULTIPLE_READERS, TBufferManagementPolicy, TDeletingPolicy, TRecycling>(management, deleting, recycling, "MULTIPLE_READERS", max_threads, duration);
+  MeasurePool<tConcurrency::FULL, TBufferManagementPolicy, TDeletingPolicy, TRecycling>(management, deleting, recycling, "FULL", max_threads, duration);
+}
+
+template <template <typename, tConcurrency, typename ...> class TBufferManagementPolicy, template <typename> class TDeletingPolicy>
+void MeasureAllRecyclingPolicies(const char* management, const char* deleting, int max_threads, std::chrono::milliseconds duration)
+{
+  MeasureAllConcurrencyLevels<TBufferManagementPolicy, TDeletingPolicy, recycling::StoreOwnerInUniquePointer>(management, deleting, "StoreOwnerInUniquePointer", max_threads, duration);
+  MeasureAllConcurrencyLevels<TBufferManagementPolicy, TDeletingPolicy, recycling::UseBufferContainer>(management, deleting, "UseBufferContainer", max_threads, duration);
+  MeasureAllConcurrencyLevels<TBufferManagementPolicy, TDeletingPolicy, recycling::UseOwnerStorageInBuffer>(management, deleting, "UseOwnerStorageInBuffer", max_threads, duration);
+}
+
+template <template <typename, tConcurrency, typename ...> class TBufferManagementPolicy>
+void MeasureAllPolicies(const char* management, int max_threads, std::chrono::milliseconds duration)
+{
+  MeasureAllRecyclingPolicies<TBufferManagementPolicy, deleting::ComplainOnMissingBuffers>(management, "ComplainOnMissingBuffers", max_threads, duration);
+  MeasureAllRecyclingPolicies<TBufferManagementPolicy, deleting::CollectGarbage>(management, "CollectGarbage", max_threads, duration);
+}
+
+int main(int argc, char **argv)
+{
+  int max_threads = argc > 1 ? atoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+  std::chrono::milliseconds duration(argc > 2 ? atoi(argv[2]) : 200);
+  if (max_threads < 1 || duration.count() <= 0)
+  {
+    fprintf(stderr, "Usage: %s [max threads] [duration per measurement in ms]\n", argv[0]);
+    return 1;
+  }
+  if (!tPerformanceCounters().Available())
+  {
+    fprintf(stderr, "Hardware performance counters are not available - counter columns remain empty.\n");
+  }
+
+  printf("management,deleting,recycling,concurrency,threads,operations,ns_per_operation,million_operations_per_second,cycles_per_operation,instructions_per_operation,cache_misses_per_operation\n");
+  MeasureBaseline(max_threads, duration);
+  MeasureAllPolicies<management::QueueBased>("QueueBased", max_threads, duration);
+  MeasureAllPolicies<management::QueueBasedWithThreadLocalCache>("QueueBasedWithThreadLocalCache", max_threads, duration);
+  MeasureAllPolicies<management::ArrayAndFlagBased>("ArrayAndFlagBased", max_threads, duration);
+  MeasureAllPolicies<management::BitmapBased>("BitmapBased", max_threads, duration);
+  MeasureAllPolicies<management::StackBased>("StackBased", max_threads, duration);
+  return 0;
+}